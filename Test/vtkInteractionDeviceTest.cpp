@@ -33,6 +33,7 @@
 #include <vtkVRPNAnalog.h>
 #include <vtkVRPNAnalogOutput.h>
 #include <vtkVRPNButton.h>
+#include <vtkVRPNConnection.h>
 #include <vtkVRPNTracker.h>
 #include <vtkVRPNTrackerStyleCamera.h>
 #include <vtkWiiMoteStyleCamera.h>
@@ -102,23 +103,33 @@ void main(int argc, char* argv[]) {
         multiTouchStyleCamera->SetRenderer(renderer);
     }
     else if (mode == 2) {
+        // A vtkVRPNConnection lets devices on the same server share one connection
+        vtkVRPNConnection* connection = vtkVRPNConnection::New();
+        connection->SetServerName("localhost");
+
         // A vtkInteractionDevice, such as a vtkVRPNAnalog, communicates with an external device
         device1 = vtkVRPNAnalog::New();
         vtkVRPNAnalog* analog = (vtkVRPNAnalog*)device1;
         analog->SetDeviceName("wiimote@localhost");
+        analog->SetConnection(connection);
         analog->Initialize();
 
         // A vtkInteractionDevice, such as a vtkVRPNAnalogOutput, communicates with an external device
         analogOutput = vtkVRPNAnalogOutput::New();
         analogOutput->SetDeviceName("wiimote@localhost");
+        analogOutput->SetConnection(connection);
         analogOutput->Initialize();
 
         // A vtkInteractionDevice, such as a vtkVRPNButton, communicates with an external device
         device2 = vtkVRPNButton::New();
         vtkVRPNButton* button = (vtkVRPNButton*)device2;
         button->SetDeviceName("wiimote@localhost");
+        button->SetConnection(connection);
         button->Initialize();
 
+        // The devices keep a reference to the connection
+        connection->Delete();
+
         // A vtkDeviceInteractorStyle, such as vtkVRPNWiiMoteStyleCamera, listens for events from 
         // vtkInteractionDevices and performs interactions based on these events.
         deviceStyle = vtkWiiMoteStyleCamera::New();
@@ -0,0 +1,256 @@
+/*=========================================================================
+
+  Name:        vtkRenciMultiTouchThreadedTest.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0.
+               
+               See included RENCI_License.txt or 
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Sends many small one_drag gestures to vtkRenciMultiTouch 
+               while it is updated from the vtkDeviceInteractor polling 
+               thread, and checks that the directions seen by the render 
+               thread add up to the total movement sent.  Then sends a 
+               one_touch, more drags and a release in one burst and checks 
+               that each gesture is still seen, in order.
+
+=========================================================================*/
+
+
+#include <vtkCallbackCommand.h>
+#include <vtkDeviceInteractor.h>
+#include <vtkRenciMultiTouch.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef WIN32
+# include <winsock.h>
+#else
+# include <arpa/inet.h>
+# include <netinet/in.h>
+# include <sys/socket.h>
+# include <unistd.h>
+# define closesocket close
+#endif
+
+
+const int port = 7790;
+const int numGestures = 2000;
+const int numBurstDrags = 50;
+const double direction[2] = { 0.01, -0.02 };
+
+
+// Append big-endian OSC arguments
+void AppendInt(char* buffer, int& length, int value)
+{
+  unsigned long v = static_cast<unsigned long>(value);
+  for (int i = 3; i >= 0; i--) buffer[length++] = static_cast<char>((v >> (i * 8)) & 0xFF);
+}
+
+void AppendDouble(char* buffer, int& length, double value)
+{
+  unsigned char bytes[8];
+  memcpy(bytes, &value, 8);
+
+  // Doubles are sent big-endian
+  unsigned long one = 1;
+  bool littleEndian = *reinterpret_cast<unsigned char*>(&one) == 1;
+  for (int i = 0; i < 8; i++) buffer[length++] = bytes[littleEndian ? 7 - i : i];
+}
+
+void AppendString(char* buffer, int& length, const char* value)
+{
+  int size = static_cast<int>(strlen(value));
+  memcpy(buffer + length, value, size);
+  length += size;
+
+  // Null terminated and padded to 4 bytes
+  do buffer[length++] = '\0'; while (length % 4 != 0);
+}
+
+// A one finger gesture of touch point 0 at (0.5, 0.5) moving by direction
+int MakeOneFinger(char* buffer, const char* name)
+{
+  int length = 0;
+  AppendString(buffer, length, "/gesture");
+  AppendString(buffer, length, ",ssiiddddi");
+  AppendString(buffer, length, "set");
+  AppendString(buffer, length, name);
+  AppendInt(buffer, length, 1);
+  AppendInt(buffer, length, 0);
+  AppendDouble(buffer, length, 0.5);
+  AppendDouble(buffer, length, 0.5);
+  AppendDouble(buffer, length, direction[0]);
+  AppendDouble(buffer, length, direction[1]);
+  AppendInt(buffer, length, 1);
+
+  return length;
+}
+
+int MakeRelease(char* buffer)
+{
+  int length = 0;
+  AppendString(buffer, length, "/gesture");
+  AppendString(buffer, length, ",ss");
+  AppendString(buffer, length, "set");
+  AppendString(buffer, length, "release");
+
+  return length;
+}
+
+void Send(int sd, struct sockaddr_in& address, const char* buffer, int length)
+{
+  sendto(sd, buffer, length, 0, 
+         reinterpret_cast<struct sockaddr*>(&address), sizeof(address));
+}
+
+
+// Sum the directions seen by the render thread
+double sum[2] = { 0.0, 0.0 };
+
+void OnOneDrag(vtkObject* caller, unsigned long, void*, void*)
+{
+  vtkRenciMultiTouch* multiTouch = static_cast<vtkRenciMultiTouch*>(caller);
+  sum[0] += multiTouch->GetTouchPoint(0).Direction[0];
+  sum[1] += multiTouch->GetTouchPoint(0).Direction[1];
+}
+
+// Record when the one_touch and release gestures are seen
+int numEvents = 0;
+int numTouches = 0;
+int numReleases = 0;
+int touchEvent = -1;
+int releaseEvent = -1;
+
+void OnGesture(vtkObject*, unsigned long eventId, void*, void*)
+{
+  if (eventId == vtkRenciMultiTouch::OneTouchEvent)
+    {
+    numTouches++;
+    touchEvent = numEvents;
+    }
+  else if (eventId == vtkRenciMultiTouch::ReleaseEvent)
+    {
+    numReleases++;
+    releaseEvent = numEvents;
+    }
+
+  numEvents++;
+}
+
+
+int main(int argc, char* argv[]) 
+{
+  // Receive on the polling thread
+  vtkRenciMultiTouch* multiTouch = vtkRenciMultiTouch::New();
+  multiTouch->SetHostName("localhost");
+  multiTouch->SetPort(port);
+  multiTouch->SetReceiveBufferSize(1 << 20);
+  if (!multiTouch->Initialize())
+    {
+    printf("Could not initialize vtkRenciMultiTouch\n");
+    multiTouch->Delete();
+    return 1;
+    }
+
+  vtkCallbackCommand* callback = vtkCallbackCommand::New();
+  callback->SetCallback(OnOneDrag);
+  multiTouch->AddObserver(vtkRenciMultiTouch::OneDragEvent, callback);
+
+  vtkCallbackCommand* gestureCallback = vtkCallbackCommand::New();
+  gestureCallback->SetCallback(OnGesture);
+  multiTouch->AddObserver(vtkRenciMultiTouch::OneTouchEvent, gestureCallback);
+  multiTouch->AddObserver(vtkRenciMultiTouch::OneDragEvent, gestureCallback);
+  multiTouch->AddObserver(vtkRenciMultiTouch::ReleaseEvent, gestureCallback);
+
+  vtkDeviceInteractor* deviceInteractor = vtkDeviceInteractor::New();
+  deviceInteractor->AddInteractionDevice(multiTouch);
+  deviceInteractor->SetPollingInterval(0.001);
+  deviceInteractor->StartPollingThread();
+
+
+  // Send the gestures a few at a time, picking them up at roughly the rate
+  // a render loop would
+  int sd = static_cast<int>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+  char buffer[128];
+  int length = MakeOneFinger(buffer, "one_drag");
+  for (int i = 0; i < numGestures; i++)
+    {
+    Send(sd, address, buffer, length);
+
+    if (i % 10 == 0) vtkDeviceInteractor::Sleep(0.0005);
+    if (i % 100 == 0) deviceInteractor->Update();
+    }
+
+  // Let the polling thread read the rest
+  for (int i = 0; i < 20; i++)
+    {
+    vtkDeviceInteractor::Sleep(0.016);
+    deviceInteractor->Update();
+    }
+
+
+  // Touch, drag and release within one frame
+  numEvents = 0;
+
+  char touchBuffer[128];
+  int touchLength = MakeOneFinger(touchBuffer, "one_touch");
+  char releaseBuffer[128];
+  int releaseLength = MakeRelease(releaseBuffer);
+
+  Send(sd, address, touchBuffer, touchLength);
+  for (int i = 0; i < numBurstDrags; i++) Send(sd, address, buffer, length);
+  Send(sd, address, releaseBuffer, releaseLength);
+  closesocket(sd);
+
+  for (int i = 0; i < 20; i++)
+    {
+    vtkDeviceInteractor::Sleep(0.016);
+    deviceInteractor->Update();
+    }
+
+  deviceInteractor->StopPollingThread();
+
+
+  // Check the total movement
+  double expected[2] = { (numGestures + numBurstDrags) * direction[0], 
+                         (numGestures + numBurstDrags) * direction[1] };
+  printf("Summed direction: (%g, %g), expected (%g, %g)\n", 
+         sum[0], sum[1], expected[0], expected[1]);
+
+  int result = fabs(sum[0] - expected[0]) < 1e-6 && 
+               fabs(sum[1] - expected[1]) < 1e-6 ? 0 : 1;
+
+  // Check the burst
+  printf("one_touch seen %d times, release seen %d times\n", numTouches, numReleases);
+
+  if (numTouches != 1 || numReleases != 1 || 
+      touchEvent != 0 || releaseEvent != numEvents - 1) 
+    {
+    printf("Gestures in the burst were lost or out of order\n");
+    result = 1;
+    }
+
+
+  // Clean up
+  deviceInteractor->Delete();
+  callback->Delete();
+  gestureCallback->Delete();
+  multiTouch->Delete();
+
+  return result;
+}
@@ -17,16 +17,139 @@
 #include "vtkDeviceInteractor.h"
 
 #include "vtkCommand.h"
+#include "vtkInteractionDeviceTripleBuffer.h"
+#include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
+#include "vtkTimerLog.h"
 #include "vtkstd/vector"
 
+#include <math.h>
+
+#ifdef _WIN32
+# include "vtkWindows.h"
+#else
+# include <time.h>
+#endif
+
+// Latency histograms have 0.1 ms bins up to 0.5 s, plus one bin for 
+// everything longer
+static const double LatencyBinWidth = 0.0001;
+static const int NumberOfLatencyBins = 5000;
+
+struct InteractionDeviceInformation
+{
+  vtkInteractionDevice* Device;
+
+  // Minimum time in seconds between updates, and the next time it is due
+  double PollInterval;
+  double NextPollTime;
+
+  // Higher priority devices are updated first
+  int Priority;
+
+  // Returns true if the device is due, and schedules the next update
+  bool Due(double now)
+    {
+    if (this->PollInterval <= 0.0) return true;
+    if (now < this->NextPollTime) return false;
+
+    // Don't try to catch up on missed updates
+    this->NextPollTime = now + this->PollInterval;
+
+    return true;
+    }
+
+  // Oldest report delivered since the last render, 0 if none
+  double PendingReportTime;
+  double PendingArrivalTime;
+
+  // Latency from when reports were sent, and from when they arrived, to 
+  // the end of the render that showed them
+  vtkstd::vector<unsigned int> Latency;
+  vtkstd::vector<unsigned int> ArrivalLatency;
+  int NumberOfLatencySamples;
+
+  // Remember the oldest report delivered by the last interaction event
+  void AddPendingReport()
+    {
+    double arrivalTime = this->Device->GetArrivalTime();
+    if (arrivalTime == 0.0) return;
+
+    if (this->PendingArrivalTime == 0.0 || arrivalTime < this->PendingArrivalTime)
+      {
+      this->PendingReportTime = this->Device->GetReportTime();
+      this->PendingArrivalTime = arrivalTime;
+      }
+    }
+
+  void ClearPendingReport()
+    {
+    this->PendingReportTime = 0.0;
+    this->PendingArrivalTime = 0.0;
+    }
+
+  void ResetLatency()
+    {
+    this->Latency.assign(NumberOfLatencyBins + 1, 0);
+    this->ArrivalLatency.assign(NumberOfLatencyBins + 1, 0);
+    this->NumberOfLatencySamples = 0;
+    }
+};
+
+// Add a latency in seconds to a histogram
+static void AddLatency(vtkstd::vector<unsigned int>& histogram, double latency)
+{
+  // Clocks of remote devices may be offset, so clamp negative latencies
+  int bin = latency > 0.0 ? static_cast<int>(latency / LatencyBinWidth) : 0;
+  if (bin > NumberOfLatencyBins) bin = NumberOfLatencyBins;
+
+  histogram[bin]++;
+}
+
+// Return the upper edge of the bin containing the percentile
+static double GetPercentile(const vtkstd::vector<unsigned int>& histogram, 
+                            int numSamples, double percentile)
+{
+  if (numSamples == 0) return 0.0;
+
+  double target = numSamples * percentile / 100.0;
+  unsigned int count = 0;
+  for (int i = 0; i <= NumberOfLatencyBins; i++)
+    {
+    count += histogram[i];
+    if (count >= target && count > 0) return (i + 1) * LatencyBinWidth;
+    }
+
+  return (NumberOfLatencyBins + 1) * LatencyBinWidth;
+}
+
 class vtkDeviceInteractorInternals
 {
 public:
-  vtkstd::vector<vtkInteractionDevice*> InteractionDevices;
+  // Sorted by decreasing priority
+  vtkstd::vector<InteractionDeviceInformation> InteractionDevices;
   vtkstd::vector<vtkDeviceInteractorStyle*> DeviceInteractorStyles;
+
+  vtkDeviceInteractor* Self;
+
+  vtkMultiThreader* Threader;
+  int PollingThreadId;
+
+  // Scheduling
+  double NextSampleTime;
+  double NextRenderTime;
+  double FrameDeadline;
+  double RenderStartTime;
+  int RenderPending;
+
+  // Written by whichever thread samples the devices, so only changed with
+  // the atomic helpers
+  volatile long NumberOfSkippedSamples;
 };
 
+// Polling thread
+static VTK_THREAD_RETURN_TYPE PollingThread(void* arg);
+
 vtkCxxRevisionMacro(vtkDeviceInteractor, "$Revision: 1.0 $");
 vtkStandardNewMacro(vtkDeviceInteractor);
 
@@ -34,14 +157,37 @@ vtkStandardNewMacro(vtkDeviceInteractor);
 vtkDeviceInteractor::vtkDeviceInteractor() 
 {
   this->Internals = new vtkDeviceInteractorInternals;
+  this->Internals->Self = this;
+
+  this->Internals->Threader = vtkMultiThreader::New();
+  this->Internals->PollingThreadId = -1;
+
+  // 1 ms keeps up with 1 kHz trackers without spinning a core
+  this->PollingInterval = 0.001;
+
+  this->RenderRequested = 1;
+
+  this->SamplingRate = 0.0;
+  this->RenderRate = 0.0;
+
+  this->Internals->NextSampleTime = 0.0;
+  this->Internals->NextRenderTime = 0.0;
+  this->Internals->FrameDeadline = 0.0;
+  this->Internals->RenderStartTime = 0.0;
+  this->Internals->RenderPending = 0;
+
+  this->ResetStatistics();
 }
 
 //----------------------------------------------------------------------------
 vtkDeviceInteractor::~vtkDeviceInteractor()
 {
+  this->StopPollingThread();
+  this->Internals->Threader->Delete();
+
   for (unsigned int i = 0; i < this->Internals->InteractionDevices.size(); i++)
     {
-    this->Internals->InteractionDevices[i]->UnRegister(this);
+    this->Internals->InteractionDevices[i].Device->UnRegister(this);
     }
 
   for (unsigned int i = 0; i < this->Internals->DeviceInteractorStyles.size(); i++)
@@ -53,28 +199,308 @@ vtkDeviceInteractor::~vtkDeviceInteractor()
 }
 
 //----------------------------------------------------------------------------
-void vtkDeviceInteractor::Update()
+int vtkDeviceInteractor::Update()
+{
+  double now = vtkTimerLog::GetUniversalTime();
+
+  if (this->GetPollingThreadRunning())
+    {
+    // Devices are updated by the polling thread
+    for (unsigned int i = 0; i < this->Internals->InteractionDevices.size(); i++) 
+      {
+      if (this->Internals->InteractionDevices[i].Device->ConsumeState())
+        {
+        this->Internals->InteractionDevices[i].Device->InvokeInteractionEvent();
+        this->Internals->InteractionDevices[i].AddPendingReport();
+        }
+      }
+    }
+  else if (this->SamplingRate <= 0.0 || now >= this->Internals->NextSampleTime)
+    {
+    for (unsigned int i = 0; i < this->Internals->InteractionDevices.size(); i++) 
+      {
+      if (!this->Internals->InteractionDevices[i].Due(now)) continue;
+
+      this->Internals->InteractionDevices[i].Device->Update();
+      this->Internals->InteractionDevices[i].Device->InvokeInteractionEvent();
+      this->Internals->InteractionDevices[i].AddPendingReport();
+      }
+
+    if (this->SamplingRate > 0.0)
+      {
+      double period = 1.0 / this->SamplingRate;
+      if (this->Internals->NextSampleTime == 0.0)
+        {
+        // First sample
+        this->Internals->NextSampleTime = now;
+        }
+      this->Internals->NextSampleTime += period;
+      if (this->Internals->NextSampleTime <= now)
+        {
+        // Fell behind, so skip to the next sample after now
+        int skipped = static_cast<int>((now - this->Internals->NextSampleTime) / period) + 1;
+        vtkInteractionDeviceAtomicAdd(&this->Internals->NumberOfSkippedSamples, skipped);
+        this->Internals->NextSampleTime += skipped * period;
+        }
+      }
+    }
+
+  // Without styles to ask, assume the scene changed
+  int dirty = this->RenderRequested || this->Internals->DeviceInteractorStyles.empty();
+  this->RenderRequested = 0;
+
+  for (unsigned int i = 0; i < this->Internals->DeviceInteractorStyles.size(); i++) 
+    {
+    if (this->Internals->DeviceInteractorStyles[i]->GetSceneModified())
+      {
+      this->Internals->DeviceInteractorStyles[i]->ClearSceneModified();
+      dirty = 1;
+      }
+    }
+
+  if (dirty) this->Internals->RenderPending = 1;
+
+  if (!this->Internals->RenderPending) 
+    {
+    // Reports that did not change the scene are never shown, so don't 
+    // count them as latency of the next render
+    for (unsigned int i = 0; i < this->Internals->InteractionDevices.size(); i++) 
+      {
+      this->Internals->InteractionDevices[i].ClearPendingReport();
+      }
+
+    return 0;
+    }
+
+  if (this->RenderRate <= 0.0)
+    {
+    this->Internals->RenderPending = 0;
+    return 1;
+    }
+
+  // Merge changes into the next frame until it is due
+  if (now < this->Internals->NextRenderTime) return 0;
+
+  // Drop frames that were missed instead of trying to catch up
+  double period = 1.0 / this->RenderRate;
+  if (now - this->Internals->NextRenderTime >= period)
+    {
+    this->Internals->NextRenderTime = now;
+    }
+
+  this->Internals->FrameDeadline = this->Internals->NextRenderTime + period;
+  this->Internals->NextRenderTime = this->Internals->FrameDeadline;
+  this->Internals->RenderPending = 0;
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+double vtkDeviceInteractor::GetTimeUntilNextDeadline()
+{
+  double now = vtkTimerLog::GetUniversalTime();
+  double next = VTK_DOUBLE_MAX;
+
+  if (!this->GetPollingThreadRunning())
+    {
+    if (this->SamplingRate > 0.0)
+      {
+      next = this->Internals->NextSampleTime;
+      }
+
+    for (unsigned int i = 0; i < this->Internals->InteractionDevices.size(); i++) 
+      {
+      if (this->Internals->InteractionDevices[i].PollInterval > 0.0 &&
+          this->Internals->InteractionDevices[i].NextPollTime < next)
+        {
+        next = this->Internals->InteractionDevices[i].NextPollTime;
+        }
+      }
+    }
+
+  if (this->Internals->RenderPending && this->RenderRate > 0.0 &&
+      this->Internals->NextRenderTime < next)
+    {
+    next = this->Internals->NextRenderTime;
+    }
+
+  if (next == VTK_DOUBLE_MAX) return VTK_DOUBLE_MAX;
+
+  return next > now ? next - now : 0.0;
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractor::BeginRender()
+{
+  this->Internals->RenderStartTime = vtkTimerLog::GetUniversalTime();
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractor::EndRender()
+{
+  double now = vtkTimerLog::GetUniversalTime();
+
+  this->LastFrameTime = now - this->Internals->RenderStartTime;
+  this->TotalFrameTime += this->LastFrameTime;
+  if (this->LastFrameTime > this->MaximumFrameTime)
+    {
+    this->MaximumFrameTime = this->LastFrameTime;
+    }
+  this->NumberOfFrames++;
+
+  if (this->RenderRate > 0.0 && now > this->Internals->FrameDeadline)
+    {
+    this->NumberOfMissedDeadlines++;
+    }
+
+  // The reports delivered since the last render are now visible
+  for (unsigned int i = 0; i < this->Internals->InteractionDevices.size(); i++) 
+    {
+    InteractionDeviceInformation& info = this->Internals->InteractionDevices[i];
+    if (info.PendingArrivalTime == 0.0) continue;
+
+    AddLatency(info.Latency, now - info.PendingReportTime);
+    AddLatency(info.ArrivalLatency, now - info.PendingArrivalTime);
+    info.NumberOfLatencySamples++;
+
+    info.ClearPendingReport();
+    }
+}
+
+//----------------------------------------------------------------------------
+double vtkDeviceInteractor::GetLatencyPercentile(int i, double percentile)
+{
+  if (i < 0 || i >= (int)this->Internals->InteractionDevices.size()) return 0.0;
+
+  InteractionDeviceInformation& info = this->Internals->InteractionDevices[i];
+
+  return GetPercentile(info.Latency, info.NumberOfLatencySamples, percentile);
+}
+
+//----------------------------------------------------------------------------
+double vtkDeviceInteractor::GetArrivalLatencyPercentile(int i, double percentile)
+{
+  if (i < 0 || i >= (int)this->Internals->InteractionDevices.size()) return 0.0;
+
+  InteractionDeviceInformation& info = this->Internals->InteractionDevices[i];
+
+  return GetPercentile(info.ArrivalLatency, info.NumberOfLatencySamples, percentile);
+}
+
+//----------------------------------------------------------------------------
+int vtkDeviceInteractor::GetNumberOfLatencySamples(int i)
+{
+  if (i < 0 || i >= (int)this->Internals->InteractionDevices.size()) return 0;
+
+  return this->Internals->InteractionDevices[i].NumberOfLatencySamples;
+}
+
+//----------------------------------------------------------------------------
+int vtkDeviceInteractor::GetNumberOfSkippedSamples()
 {
+  return static_cast<int>(vtkInteractionDeviceAtomicLoad(&this->Internals->NumberOfSkippedSamples));
+}
+
+//----------------------------------------------------------------------------
+double vtkDeviceInteractor::GetAverageFrameTime()
+{
+  if (this->NumberOfFrames == 0) return 0.0;
+
+  return this->TotalFrameTime / this->NumberOfFrames;
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractor::ResetStatistics()
+{
+  this->NumberOfFrames = 0;
+  this->NumberOfMissedDeadlines = 0;
+  vtkInteractionDeviceAtomicExchange(&this->Internals->NumberOfSkippedSamples, 0);
+  this->LastFrameTime = 0.0;
+  this->MaximumFrameTime = 0.0;
+  this->TotalFrameTime = 0.0;
+
   for (unsigned int i = 0; i < this->Internals->InteractionDevices.size(); i++) 
     {
-    this->Internals->InteractionDevices[i]->Update();
-    this->Internals->InteractionDevices[i]->InvokeInteractionEvent();
+    this->Internals->InteractionDevices[i].ResetLatency();
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkDeviceInteractor::StartPollingThread()
+{
+  if (this->GetPollingThreadRunning()) return;
+
+  for (unsigned int i = 0; i < this->Internals->InteractionDevices.size(); i++) 
+    {
+    this->Internals->InteractionDevices[i].Device->SetThreaded(1);
+    }
+
+  this->Internals->PollingThreadId = 
+    this->Internals->Threader->SpawnThread(PollingThread, this->Internals);
+
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractor::StopPollingThread()
+{
+  if (!this->GetPollingThreadRunning()) return;
+
+  // Blocks until the thread exits
+  this->Internals->Threader->TerminateThread(this->Internals->PollingThreadId);
+  this->Internals->PollingThreadId = -1;
+
+  for (unsigned int i = 0; i < this->Internals->InteractionDevices.size(); i++) 
+    {
+    this->Internals->InteractionDevices[i].Device->SetThreaded(0);
+    }
+
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkDeviceInteractor::GetPollingThreadRunning()
+{
+  return this->Internals->PollingThreadId >= 0;
+}
+
 //----------------------------------------------------------------------------
 void vtkDeviceInteractor::AddInteractionDevice(vtkInteractionDevice* device)
+{
+  this->AddInteractionDevice(device, 0.0, 0);
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractor::AddInteractionDevice(vtkInteractionDevice* device, 
+                                               double pollInterval, int priority)
 {
   if (device == NULL) return;
 
   for (unsigned int i = 0; i < this->Internals->InteractionDevices.size(); i++) 
     {
-    if (this->Internals->InteractionDevices[i] == device) return;
+    if (this->Internals->InteractionDevices[i].Device == device) return;
     }
 
-  this->Internals->InteractionDevices.push_back(device);
+  // The polling thread iterates over the devices, so stop it while changing them
+  int running = this->GetPollingThreadRunning();
+  this->StopPollingThread();
+
+  InteractionDeviceInformation info;
+  info.Device = device;
+  info.PollInterval = pollInterval > 0.0 ? pollInterval : 0.0;
+  info.NextPollTime = 0.0;
+  info.Priority = priority;
+  info.ClearPendingReport();
+  info.ResetLatency();
+
+  // Insert after devices of the same or higher priority
+  vtkstd::vector<InteractionDeviceInformation>::iterator it = this->Internals->InteractionDevices.begin();
+  while (it != this->Internals->InteractionDevices.end() && it->Priority >= priority) ++it;
+  this->Internals->InteractionDevices.insert(it, info);
+
+  device->Register(this);
 
-  this->Internals->InteractionDevices.back()->Register(this);
+  if (running) this->StartPollingThread();
 }
 
 //----------------------------------------------------------------------------
@@ -84,16 +510,51 @@ void vtkDeviceInteractor::RemoveInteractionDevice(vtkInteractionDevice* device)
 
   for (unsigned int i = 0; i < this->Internals->InteractionDevices.size(); i++) 
     {
-    if (this->Internals->InteractionDevices[i] == device) 
+    if (this->Internals->InteractionDevices[i].Device == device) 
       {
-      this->Internals->InteractionDevices[i]->UnRegister(this);
+      int running = this->GetPollingThreadRunning();
+      this->StopPollingThread();
+
+      this->Internals->InteractionDevices[i].Device->UnRegister(this);
       this->Internals->InteractionDevices.erase(this->Internals->InteractionDevices.begin() + i);
 
+      if (running) this->StartPollingThread();
+
       return;
       }
     }
 }
 
+//----------------------------------------------------------------------------
+int vtkDeviceInteractor::GetNumberOfInteractionDevices()
+{
+  return this->Internals->InteractionDevices.size();
+}
+
+//----------------------------------------------------------------------------
+vtkInteractionDevice* vtkDeviceInteractor::GetInteractionDevice(int i)
+{
+  if (i < 0 || i >= (int)this->Internals->InteractionDevices.size()) return NULL;
+
+  return this->Internals->InteractionDevices[i].Device;
+}
+
+//----------------------------------------------------------------------------
+double vtkDeviceInteractor::GetInteractionDevicePollInterval(int i)
+{
+  if (i < 0 || i >= (int)this->Internals->InteractionDevices.size()) return 0.0;
+
+  return this->Internals->InteractionDevices[i].PollInterval;
+}
+
+//----------------------------------------------------------------------------
+int vtkDeviceInteractor::GetInteractionDevicePriority(int i)
+{
+  if (i < 0 || i >= (int)this->Internals->InteractionDevices.size()) return 0;
+
+  return this->Internals->InteractionDevices[i].Priority;
+}
+
 //----------------------------------------------------------------------------
 void vtkDeviceInteractor::AddDeviceInteractorStyle(vtkDeviceInteractorStyle* device)
 {
@@ -126,15 +587,102 @@ void vtkDeviceInteractor::RemoveDeviceInteractorStyle(vtkDeviceInteractorStyle*
     }
 }
 
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE PollingThread(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkDeviceInteractorInternals* internals = static_cast<vtkDeviceInteractorInternals*>(info->UserData);
+
+  double nextSampleTime = vtkTimerLog::GetUniversalTime();
+
+  while (1)
+    {
+    info->ActiveFlagLock->Lock();
+    int active = *info->ActiveFlag;
+    info->ActiveFlagLock->Unlock();
+
+    if (!active) break;
+
+    double now = vtkTimerLog::GetUniversalTime();
+    for (unsigned int i = 0; i < internals->InteractionDevices.size(); i++) 
+      {
+      if (!internals->InteractionDevices[i].Due(now)) continue;
+
+      internals->InteractionDevices[i].Device->Update();
+      internals->InteractionDevices[i].Device->PublishState();
+      }
+
+    // Sleep until the next sample is due, or for the polling interval if 
+    // there is no sampling rate
+    double samplingRate = internals->Self->GetSamplingRate();
+    if (samplingRate > 0.0)
+      {
+      double now = vtkTimerLog::GetUniversalTime();
+      double period = 1.0 / samplingRate;
+      nextSampleTime += period;
+      if (nextSampleTime <= now)
+        {
+        // Fell behind, so skip to the next sample after now
+        int skipped = static_cast<int>((now - nextSampleTime) / period) + 1;
+        vtkInteractionDeviceAtomicAdd(&internals->NumberOfSkippedSamples, skipped);
+        nextSampleTime += skipped * period;
+        }
+      vtkDeviceInteractor::Sleep(nextSampleTime - now);
+      }
+    else
+      {
+      vtkDeviceInteractor::Sleep(internals->Self->GetPollingInterval());
+      }
+    }
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractor::Sleep(double seconds)
+{
+#ifdef _WIN32
+  // Round up, so sleeps under 1 ms don't return immediately
+  ::Sleep(static_cast<DWORD>(ceil(seconds * 1000.0)));
+#else
+  struct timespec t;
+  t.tv_sec = static_cast<time_t>(seconds);
+  t.tv_nsec = static_cast<long>((seconds - t.tv_sec) * 1.0e9);
+  nanosleep(&t, NULL);
+#endif
+}
+
 //----------------------------------------------------------------------------
 void vtkDeviceInteractor::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
 
+  os << indent << "PollingThreadRunning: " << this->GetPollingThreadRunning() << "\n";
+  os << indent << "PollingInterval: " << this->PollingInterval << "\n";
+  os << indent << "RenderRequested: " << this->RenderRequested << "\n";
+  os << indent << "SamplingRate: " << this->SamplingRate << "\n";
+  os << indent << "RenderRate: " << this->RenderRate << "\n";
+  os << indent << "NumberOfFrames: " << this->NumberOfFrames << "\n";
+  os << indent << "NumberOfMissedDeadlines: " << this->NumberOfMissedDeadlines << "\n";
+  os << indent << "NumberOfSkippedSamples: " << this->GetNumberOfSkippedSamples() << "\n";
+  os << indent << "LastFrameTime: " << this->LastFrameTime << "\n";
+  os << indent << "MaximumFrameTime: " << this->MaximumFrameTime << "\n";
+  os << indent << "AverageFrameTime: " << this->GetAverageFrameTime() << "\n";
+
   os << indent << "InteractionDevices:" << endl;
   for (unsigned int i = 0; i < this->Internals->InteractionDevices.size(); i++)
     {
-    os << indent; this->Internals->InteractionDevices[i]->PrintSelf(os,indent.GetNextIndent());
+    os << indent << "PollInterval: " << this->Internals->InteractionDevices[i].PollInterval
+       << " Priority: " << this->Internals->InteractionDevices[i].Priority << "\n";
+    os << indent << "Latency p50/p95/p99: " 
+       << this->GetLatencyPercentile(i, 50.0) << " " 
+       << this->GetLatencyPercentile(i, 95.0) << " "
+       << this->GetLatencyPercentile(i, 99.0) << "\n";
+    os << indent << "ArrivalLatency p50/p95/p99: " 
+       << this->GetArrivalLatencyPercentile(i, 50.0) << " " 
+       << this->GetArrivalLatencyPercentile(i, 95.0) << " "
+       << this->GetArrivalLatencyPercentile(i, 99.0) << "\n";
+    os << indent; this->Internals->InteractionDevices[i].Device->PrintSelf(os,indent.GetNextIndent());
     }
   os << indent << "DeviceInteractorStyles:" << endl;
   for (unsigned int i = 0; i < this->Internals->DeviceInteractorStyles.size(); i++)
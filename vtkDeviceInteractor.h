@@ -44,16 +44,116 @@ public:
   void PrintSelf(ostream& os, vtkIndent indent);
 
   // Description:
-  // Updates devices
-  void Update();
+  // Updates devices.  If the polling thread is running, only invokes
+  // interaction events for devices that have published new state.
+  // Returns 1 if the scene should be rendered now, i.e. a device interactor 
+  // style modified the scene or RequestRender() was called, and the next 
+  // render deadline has been reached.  Otherwise returns 0, and any scene
+  // changes are merged into the next render.  If no styles have been added,
+  // the scene is always considered modified.
+  int Update();
 
   // Description:
-  // Add/Remove interaction devices
+  // Rate in Hz at which devices are sampled.  Update() skips sampling until
+  // the next sample is due, and the polling thread sleeps until then.  If 
+  // sampling falls behind, the missed samples are skipped rather than 
+  // caught up in a burst.  0 samples on every call to Update().
+  vtkSetClampMacro(SamplingRate,double,0.0,VTK_DOUBLE_MAX);
+  vtkGetMacro(SamplingRate,double);
+
+  // Description:
+  // Target rate in Hz at which to render.  Scene changes are held until the
+  // next render deadline, merging all device updates in between into one 
+  // frame.  If rendering falls behind, missed frames are dropped rather 
+  // than rendered late.  0 renders as soon as the scene changes.
+  vtkSetClampMacro(RenderRate,double,0.0,VTK_DOUBLE_MAX);
+  vtkGetMacro(RenderRate,double);
+
+  // Description:
+  // Time in seconds until the next sample or render is due, or VTK_DOUBLE_MAX
+  // if nothing is scheduled.  Event loops use this to bound how long they 
+  // wait for events.
+  double GetTimeUntilNextDeadline();
+
+  // Description:
+  // Event loops call these around Render() to measure frame times and 
+  // missed render deadlines.
+  void BeginRender();
+  void EndRender();
+
+  // Description:
+  // Scheduling statistics.  A render deadline is missed when a frame 
+  // finishes after the time the next frame should have started.
+  vtkGetMacro(NumberOfFrames,int);
+  vtkGetMacro(NumberOfMissedDeadlines,int);
+  int GetNumberOfSkippedSamples();
+  vtkGetMacro(LastFrameTime,double);
+  vtkGetMacro(MaximumFrameTime,double);
+  double GetAverageFrameTime();
+  void ResetStatistics();
+
+  // Description:
+  // Input latency statistics for interaction device i, in seconds, 
+  // measured at EndRender() for each frame that showed new reports from 
+  // the device.  Latency is measured from when the oldest report in the 
+  // frame was sent by the device, so it includes network time but is only
+  // meaningful if the device and this machine have synchronized clocks.  
+  // ArrivalLatency is measured from when it was received here.  Percentiles
+  // are in [0, 100], e.g. 50, 95, or 99, with 0.1 ms resolution up to 0.5 s.
+  // Reset by ResetStatistics().
+  double GetLatencyPercentile(int i, double percentile);
+  double GetArrivalLatencyPercentile(int i, double percentile);
+  int GetNumberOfLatencySamples(int i);
+
+  // Description:
+  // Force the next Update() to report that the scene needs rendering.  Call 
+  // this after changing the scene outside of the device interactor styles.
+  void RequestRender() { this->RenderRequested = 1; }
+
+  // Description:
+  // Start/stop a background thread that continuously receives updates 
+  // from the interaction devices.  While the thread is running, device
+  // updates are decoupled from the render rate, and Update() just picks 
+  // up the newest state published by each device and invokes interaction 
+  // events on the calling thread, so device interactor styles never run 
+  // on the polling thread.  Adding or removing devices restarts the thread.
+  void StartPollingThread();
+  void StopPollingThread();
+  int GetPollingThreadRunning();
+
+  // Description:
+  // Time in seconds the polling thread sleeps between device updates.  
+  // Ignored if SamplingRate is set.
+  vtkSetClampMacro(PollingInterval,double,0.0,VTK_DOUBLE_MAX);
+  vtkGetMacro(PollingInterval,double);
+
+  // Description:
+  // Sleep for the given number of seconds.  Used for pacing event loops.
+  static void Sleep(double seconds);
+
+  // Description:
+  // Add/Remove interaction devices.  A device can be given a poll interval
+  // in seconds, in which case it is only updated when at least that much 
+  // time has passed since its last update, and a priority.  Devices with
+  // higher priority are updated first, and devices with equal priority in 
+  // the order they were added.  The default is to update the device every
+  // time devices are sampled, with priority 0.
   void AddInteractionDevice(vtkInteractionDevice*);
+  void AddInteractionDevice(vtkInteractionDevice*, double pollInterval, int priority);
   void RemoveInteractionDevice(vtkInteractionDevice*);
 
   // Description:
-  // Add/Remove device interactor styles.  This is just used for book-keeping.
+  // Access the interaction devices, in priority order
+  int GetNumberOfInteractionDevices();
+  vtkInteractionDevice* GetInteractionDevice(int i);
+  double GetInteractionDevicePollInterval(int i);
+  int GetInteractionDevicePriority(int i);
+
+  // Description:
+  // Add/Remove device interactor styles.  Update() only checks the added 
+  // styles' SceneModified flags to determine whether the scene needs 
+  // rendering.  The styles apply their camera changes and clipping ranges
+  // themselves when their renderer starts rendering.
   void AddDeviceInteractorStyle(vtkDeviceInteractorStyle*);
   void RemoveDeviceInteractorStyle(vtkDeviceInteractorStyle*);
 
@@ -63,6 +163,19 @@ protected:
 
   vtkDeviceInteractorInternals* Internals;
 
+  double PollingInterval;
+
+  int RenderRequested;
+
+  double SamplingRate;
+  double RenderRate;
+
+  int NumberOfFrames;
+  int NumberOfMissedDeadlines;
+  double LastFrameTime;
+  double MaximumFrameTime;
+  double TotalFrameTime;
+
 private:
   vtkDeviceInteractor(const vtkDeviceInteractor&);  // Not implemented.
   void operator=(const vtkDeviceInteractor&);  // Not implemented.
@@ -16,6 +16,15 @@
 
 #include "vtkDeviceInteractorStyle.h"
 
+#include "vtkCamera.h"
+#include "vtkCommand.h"
+#include "vtkDeviceViewTransform.h"
+#include "vtkMath.h"
+#include "vtkProp.h"
+#include "vtkPropCollection.h"
+
+#include <math.h>
+
 vtkCxxRevisionMacro(vtkDeviceInteractorStyle, "$Revision: 1.0 $");
 
 //----------------------------------------------------------------------------
@@ -23,9 +32,26 @@ vtkDeviceInteractorStyle::vtkDeviceInteractorStyle()
 {
   this->Renderer = NULL;
 
+  this->ViewTransform = vtkDeviceViewTransform::New();
+
+  this->SceneModified = 0;
+  this->RenderOnSceneModified = 0;
+
+  this->ClippingRangeModified = 0;
+  this->SceneBoundsMTime = 0;
+  this->SceneBoundsNumberOfProps = 0;
+  for (int i = 0; i < 6; i++) this->SceneBounds[i] = 0.0;
+
+  this->ClearCameraChanges();
+
   this->DeviceCallback = vtkCallbackCommand::New();
   this->DeviceCallback->SetClientData(this);
   this->DeviceCallback->SetCallback(vtkDeviceInteractorStyle::ProcessEvents);
+
+  this->RenderCallback = vtkCallbackCommand::New();
+  this->RenderCallback->SetClientData(this);
+  this->RenderCallback->SetCallback(vtkDeviceInteractorStyle::ProcessRenderEvents);
+  this->RenderObserverTag = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -34,6 +60,9 @@ vtkDeviceInteractorStyle::~vtkDeviceInteractorStyle()
   this->DeviceCallback->Delete();
 
   this->SetRenderer(NULL);
+  this->RenderCallback->Delete();
+
+  this->ViewTransform->UnRegister(this);
 }
 
 //----------------------------------------------------------------------------
@@ -46,6 +75,7 @@ void vtkDeviceInteractorStyle::SetRenderer(vtkRenderer* renderer)
 
   if (this->Renderer != NULL) 
     {
+    this->Renderer->RemoveObserver(this->RenderObserverTag);
     this->Renderer->UnRegister(this);
     }
 
@@ -54,11 +84,328 @@ void vtkDeviceInteractorStyle::SetRenderer(vtkRenderer* renderer)
   if (this->Renderer != NULL) 
     {
     this->Renderer->Register(this);
+    this->RenderObserverTag = this->Renderer->AddObserver(vtkCommand::StartEvent, 
+                                                          this->RenderCallback);
+    }
+
+  this->ViewTransform->SetRenderer(renderer);
+
+  // The cached bounds are for the old renderer
+  this->SceneBoundsMTime = 0;
+  this->ClippingRangeModified = 1;
+
+  this->Modified();
+} 
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractorStyle::SetViewTransform(vtkDeviceViewTransform* transform)
+{  
+  if (this->ViewTransform == transform)
+    {
+    return;
+    }
+
+  if (transform == NULL)
+    {
+    vtkErrorMacro(<<"ViewTransform cannot be NULL.");
+    return;
     }
 
+  this->ViewTransform->UnRegister(this);
+  this->ViewTransform = transform;
+  this->ViewTransform->Register(this);
+
+  this->ViewTransform->SetRenderer(this->Renderer);
+
   this->Modified();
 } 
 
+//----------------------------------------------------------------------------
+unsigned long vtkDeviceInteractorStyle::GetPropsMTime()
+{
+  vtkPropCollection* props = this->Renderer->GetViewProps();
+  unsigned long mTime = props->GetMTime();
+
+  vtkCollectionSimpleIterator it;
+  props->InitTraversal(it);
+  vtkProp* prop;
+  while ((prop = props->GetNextProp(it)))
+    {
+    // Includes the mappers and their inputs, so modified data is caught
+    unsigned long propMTime = prop->GetRedrawMTime();
+    if (propMTime > mTime) mTime = propMTime;
+    }
+
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractorStyle::UpdateClippingRange()
+{
+  if (!this->ClippingRangeModified || !this->Renderer) return;
+
+  this->ClippingRangeModified = 0;
+
+  // Walking the props is cheap compared to computing their bounds, which
+  // can touch every point of the data
+  unsigned long mTime = this->GetPropsMTime();
+  int numProps = this->Renderer->GetViewProps()->GetNumberOfItems();
+  if (mTime != this->SceneBoundsMTime || numProps != this->SceneBoundsNumberOfProps)
+    {
+    this->Renderer->ComputeVisiblePropBounds(this->SceneBounds);
+    this->SceneBoundsMTime = mTime;
+    this->SceneBoundsNumberOfProps = numProps;
+    }
+
+  // No visible props
+  if (this->SceneBounds[0] > this->SceneBounds[1]) return;
+
+  // Only the camera moved, so near and far are computed from the cached box
+  this->Renderer->ResetCameraClippingRange(this->SceneBounds);
+}
+
+//----------------------------------------------------------------------------
+// Rows are the camera's right, up, and backward directions in world space
+static bool ComputeCameraBasis(const double position[3], const double focalPoint[3],
+                               const double viewUp[3], double basis[3][3])
+{
+  for (int i = 0; i < 3; i++) basis[2][i] = position[i] - focalPoint[i];
+  vtkMath::Cross(viewUp, basis[2], basis[0]);
+  if (vtkMath::Normalize(basis[2]) == 0.0 || vtkMath::Normalize(basis[0]) == 0.0)
+    {
+    return false;
+    }
+  vtkMath::Cross(basis[2], basis[0], basis[1]);
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Quaternions are (w, x, y, z)
+static void MultiplyQuaternion(const double a[4], const double b[4], double c[4])
+{
+  double w = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+  double x = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+  double y = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+  double z = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+
+  c[0] = w;
+  c[1] = x;
+  c[2] = y;
+  c[3] = z;
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractorStyle::GetCameraPose(double position[3], double focalPoint[3], 
+                                             double viewUp[3])
+{
+  if (this->CameraPoseSet)
+    {
+    for (int i = 0; i < 3; i++)
+      {
+      position[i] = this->CameraPosition[i];
+      focalPoint[i] = this->CameraFocalPoint[i];
+      viewUp[i] = this->CameraViewUp[i];
+      }
+    }
+  else
+    {
+    vtkCamera* camera = this->Renderer->GetActiveCamera();
+    camera->GetPosition(position);
+    camera->GetFocalPoint(focalPoint);
+    camera->GetViewUp(viewUp);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractorStyle::RotateCamera(const double axis[3], double angle)
+{
+  double halfAngle = 0.5 * angle * vtkMath::DoubleDegreesToRadians();
+  double s = sin(halfAngle);
+  double q[4] = { cos(halfAngle), s * axis[0], s * axis[1], s * axis[2] };
+
+  // Each rotation is about the axes of the camera after the previous ones
+  MultiplyQuaternion(this->CameraRotation, q, this->CameraRotation);
+
+  // Keep rounding errors from building up
+  double norm = sqrt(this->CameraRotation[0] * this->CameraRotation[0] +
+                     this->CameraRotation[1] * this->CameraRotation[1] +
+                     this->CameraRotation[2] * this->CameraRotation[2] +
+                     this->CameraRotation[3] * this->CameraRotation[3]);
+  for (int i = 0; i < 4; i++) this->CameraRotation[i] /= norm;
+
+  this->CameraModified = 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractorStyle::AzimuthCamera(double angle)
+{
+  // About the view up
+  double axis[3] = { 0.0, 1.0, 0.0 };
+  this->RotateCamera(axis, angle);
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractorStyle::ElevationCamera(double angle)
+{
+  // About the cross product of the direction of projection and view up
+  double axis[3] = { -1.0, 0.0, 0.0 };
+  this->RotateCamera(axis, angle);
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractorStyle::RollCamera(double angle)
+{
+  // About the direction of projection
+  double axis[3] = { 0.0, 0.0, -1.0 };
+  this->RotateCamera(axis, angle);
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractorStyle::DollyCamera(double factor)
+{
+  if (factor <= 0.0) return;
+
+  this->CameraDolly *= factor;
+  this->CameraModified = 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractorStyle::ZoomCameraParallelScale(double factor)
+{
+  if (factor <= 0.0) return;
+
+  this->CameraParallelScaleFactor *= factor;
+  this->CameraModified = 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractorStyle::TranslateCamera(const double motion[3])
+{
+  if (!this->Renderer) return;
+
+  double position[3], focalPoint[3], viewUp[3], basis[3][3];
+  this->GetCameraPose(position, focalPoint, viewUp);
+  if (!ComputeCameraBasis(position, focalPoint, viewUp, basis)) return;
+
+  // The motion was computed from the camera without the changes so far, so
+  // move along the rotated camera axes instead
+  double local[3], rotation[3][3];
+  vtkMath::Multiply3x3(basis, motion, local);
+  vtkMath::QuaternionToMatrix3x3(this->CameraRotation, rotation);
+  vtkMath::Multiply3x3(rotation, local, local);
+
+  for (int i = 0; i < 3; i++) this->CameraTranslation[i] += local[i];
+  this->CameraModified = 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractorStyle::SetCameraPose(const double position[3], 
+                                             const double focalPoint[3],
+                                             const double viewUp[3])
+{
+  this->ClearCameraChanges();
+
+  for (int i = 0; i < 3; i++)
+    {
+    this->CameraPosition[i] = position[i];
+    this->CameraFocalPoint[i] = focalPoint[i];
+    this->CameraViewUp[i] = viewUp[i];
+    }
+
+  this->CameraPoseSet = 1;
+  this->CameraModified = 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractorStyle::ClearCameraChanges()
+{
+  this->CameraModified = 0;
+  this->CameraPoseSet = 0;
+
+  for (int i = 0; i < 3; i++)
+    {
+    this->CameraPosition[i] = 0.0;
+    this->CameraFocalPoint[i] = 0.0;
+    this->CameraViewUp[i] = 0.0;
+    this->CameraTranslation[i] = 0.0;
+    }
+
+  this->CameraRotation[0] = 1.0;
+  this->CameraRotation[1] = 0.0;
+  this->CameraRotation[2] = 0.0;
+  this->CameraRotation[3] = 0.0;
+
+  this->CameraDolly = 1.0;
+  this->CameraParallelScaleFactor = 1.0;
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractorStyle::ApplyCameraChanges()
+{
+  if (!this->CameraModified || !this->Renderer) return;
+
+  vtkCamera* camera = this->Renderer->GetActiveCamera();
+
+  if (this->CameraParallelScaleFactor != 1.0)
+    {
+    camera->SetParallelScale(camera->GetParallelScale() / this->CameraParallelScaleFactor);
+    }
+
+  bool moved = this->CameraPoseSet || this->CameraDolly != 1.0 ||
+               this->CameraRotation[0] != 1.0 ||
+               this->CameraTranslation[0] != 0.0 ||
+               this->CameraTranslation[1] != 0.0 ||
+               this->CameraTranslation[2] != 0.0;
+  if (!moved)
+    {
+    this->ClearCameraChanges();
+    return;
+    }
+
+  double position[3], focalPoint[3], viewUp[3], basis[3][3];
+  this->GetCameraPose(position, focalPoint, viewUp);
+
+  if (ComputeCameraBasis(position, focalPoint, viewUp, basis))
+    {
+    // Rotate and dolly the position about the focal point, and rotate the
+    // view up, in camera coordinates
+    double rotation[3][3];
+    vtkMath::QuaternionToMatrix3x3(this->CameraRotation, rotation);
+
+    double offset[3], up[3];
+    for (int i = 0; i < 3; i++) offset[i] = position[i] - focalPoint[i];
+    vtkMath::Multiply3x3(basis, offset, offset);
+    vtkMath::Multiply3x3(rotation, offset, offset);
+    vtkMath::Multiply3x3(basis, viewUp, up);
+    vtkMath::Multiply3x3(rotation, up, up);
+
+    // Back to world coordinates with the transpose of the basis
+    for (int i = 0; i < 3; i++)
+      {
+      double worldOffset = 0.0;
+      double worldUp = 0.0;
+      double worldTranslation = 0.0;
+      for (int j = 0; j < 3; j++)
+        {
+        worldOffset += basis[j][i] * offset[j];
+        worldUp += basis[j][i] * up[j];
+        worldTranslation += basis[j][i] * this->CameraTranslation[j];
+        }
+
+      focalPoint[i] += worldTranslation;
+      position[i] = focalPoint[i] + worldOffset / this->CameraDolly;
+      viewUp[i] = worldUp;
+      }
+    }
+
+  camera->SetPosition(position);
+  camera->SetFocalPoint(focalPoint);
+  camera->SetViewUp(viewUp);
+
+  this->ClearCameraChanges();
+}
+
 //----------------------------------------------------------------------------
 void vtkDeviceInteractorStyle::ProcessEvents(vtkObject* caller, 
                                              unsigned long eid,
@@ -67,6 +414,20 @@ void vtkDeviceInteractorStyle::ProcessEvents(vtkObject* caller,
 {  
   vtkDeviceInteractorStyle* self = static_cast<vtkDeviceInteractorStyle*>(clientdata);
   self->OnEvent(caller, eid, calldata);
+
+  // Assume the event changed the scene unless the style says otherwise
+  if (!self->RenderOnSceneModified) self->SceneModified = 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceInteractorStyle::ProcessRenderEvents(vtkObject* caller, 
+                                                   unsigned long eid,
+                                                   void* clientdata, 
+                                                   void* calldata) 
+{  
+  vtkDeviceInteractorStyle* self = static_cast<vtkDeviceInteractorStyle*>(clientdata);
+  self->ApplyCameraChanges();
+  self->UpdateClippingRange();
 }
 
 //----------------------------------------------------------------------------
@@ -74,8 +435,17 @@ void vtkDeviceInteractorStyle::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
 
+  os << indent << "SceneModified: " << this->SceneModified << "\n";
+  os << indent << "RenderOnSceneModified: " << this->RenderOnSceneModified << "\n";
+  os << indent << "CameraModified: " << this->CameraModified << "\n";
+  os << indent << "ClippingRangeModified: " << this->ClippingRangeModified << "\n";
+  os << indent << "SceneBounds: (" << this->SceneBounds[0] << ", " << this->SceneBounds[1] << ", "
+     << this->SceneBounds[2] << ", " << this->SceneBounds[3] << ", " 
+     << this->SceneBounds[4] << ", " << this->SceneBounds[5] << ")\n";
   os << indent << "Renderer:\n";
   this->Renderer->PrintSelf(os,indent.GetNextIndent());
+  os << indent << "ViewTransform:\n";
+  this->ViewTransform->PrintSelf(os,indent.GetNextIndent());
   os << indent << "DeviceCallback:\n";
   this->DeviceCallback->PrintSelf(os,indent.GetNextIndent());
 }
\ No newline at end of file
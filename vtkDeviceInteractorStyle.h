@@ -34,6 +34,8 @@
 #include "vtkCallbackCommand.h"
 #include "vtkRenderer.h"
 
+class vtkDeviceViewTransform;
+
 class VTK_INTERACTIONDEVICE_EXPORT vtkDeviceInteractorStyle : public vtkObject
 {
 public:
@@ -48,14 +50,129 @@ public:
   // Set the renderer being used
   void SetRenderer(vtkRenderer* renderer);
 
+  // Description:
+  // Set the cached world/display transform used by the style.  Each style
+  // creates its own, and styles using the same renderer can share one.  
+  // Its renderer is set to the style's renderer.
+  void SetViewTransform(vtkDeviceViewTransform* transform);
+  vtkGetObjectMacro(ViewTransform,vtkDeviceViewTransform);
+
+  // Description:
+  // Whether the style has changed the camera or props since the flag was 
+  // last cleared.  Used by vtkDeviceInteractor to only render when needed.
+  vtkGetMacro(SceneModified,int);
+  void ClearSceneModified() { this->SceneModified = 0; }
+
+  // Description:
+  // Only mark the scene modified when the style sets SceneModified itself.
+  // Off by default, so every device event handled by the style marks the 
+  // scene modified and causes a render, which is what styles written 
+  // before SceneModified existed need.  Styles that set SceneModified 
+  // whenever they change the camera or props, like the camera styles in 
+  // this library, turn it on so events that change nothing don't render.
+  vtkSetMacro(RenderOnSceneModified,int);
+  vtkGetMacro(RenderOnSceneModified,int);
+  vtkBooleanMacro(RenderOnSceneModified,int);
+
+  // Description:
+  // Reset the camera clipping range if the style moved the camera since the
+  // last call.  Called when the renderer starts rendering, after 
+  // ApplyCameraChanges(), so it happens once for each frame rendered no 
+  // matter what drives rendering.  The bounds of the visible props are 
+  // cached, and only recomputed when a prop or the renderer's list of props
+  // has been modified.
+  void UpdateClippingRange();
+
+  // Description:
+  // Apply the camera changes made by the style since the last call to the
+  // active camera, all at once.  Called when the renderer starts rendering.
+  void ApplyCameraChanges();
+
 protected:
   vtkDeviceInteractorStyle();
   ~vtkDeviceInteractorStyle();
 
   vtkRenderer* Renderer;
+
+  vtkDeviceViewTransform* ViewTransform;
+
+  // Set by subclasses whenever they change the scene
+  int SceneModified;
+
+  int RenderOnSceneModified;
+
+  // Description:
+  // Called by subclasses instead of Renderer->ResetCameraClippingRange()
+  // after moving the camera.  The reset is deferred to the next call to
+  // UpdateClippingRange(), so it happens at most once per frame.
+  void ResetCameraClippingRange() { this->ClippingRangeModified = 1; }
+
+  int ClippingRangeModified;
+
+  // Description:
+  // Called by subclasses instead of changing the active camera directly.
+  // The changes are accumulated and applied by ApplyCameraChanges(), so the
+  // camera is only modified once per frame no matter how many events are
+  // handled.  Angles are in degrees, and act like the vtkCamera methods of
+  // the same name.  TranslateCamera() moves the position and focal point by
+  // a world space vector computed from the current camera.  
+  // ZoomCameraParallelScale() divides the parallel scale by the factor.
+  // SetCameraPose() replaces the camera pose and discards earlier changes.
+  void AzimuthCamera(double angle);
+  void ElevationCamera(double angle);
+  void RollCamera(double angle);
+  void DollyCamera(double factor);
+  void ZoomCameraParallelScale(double factor);
+  void TranslateCamera(const double motion[3]);
+  void SetCameraPose(const double position[3], const double focalPoint[3],
+                     const double viewUp[3]);
+
+  // Description:
+  // Discard the camera changes not applied yet
+  void ClearCameraChanges();
+
+  // Rotate about the focal point around an axis in camera coordinates
+  void RotateCamera(const double axis[3], double angle);
+
+  // Get the position, focal point, and view up the changes are relative to
+  void GetCameraPose(double position[3], double focalPoint[3], double viewUp[3]);
+
+  // Accumulated camera changes.  Rotation and translation are in the
+  // coordinates of the camera when the changes were started.
+  int CameraModified;
+  int CameraPoseSet;
+  double CameraPosition[3];
+  double CameraFocalPoint[3];
+  double CameraViewUp[3];
+  double CameraRotation[4];
+  double CameraTranslation[3];
+  double CameraDolly;
+  double CameraParallelScaleFactor;
+
+  // Cached bounds of the visible props, and the latest modification time 
+  // of the props when they were computed
+  double SceneBounds[6];
+  unsigned long SceneBoundsMTime;
+  int SceneBoundsNumberOfProps;
+
+  // Description:
+  // Latest modification time of the renderer's list of props and of the
+  // props themselves
+  unsigned long GetPropsMTime();
   
   vtkCallbackCommand* DeviceCallback;
 
+  // Applies the deferred changes when the renderer starts rendering
+  vtkCallbackCommand* RenderCallback;
+  unsigned long RenderObserverTag;
+
+  // Description:
+  // Calls ApplyCameraChanges() and UpdateClippingRange()
+  static void ProcessRenderEvents(vtkObject* caller, 
+                                  unsigned long eid,
+                                  void* clientdata, 
+                                  void* calldata);
+
   // Description:
   // Calls the OnEvent() method to act on subclasses 
   static void ProcessEvents(vtkObject* caller, 
@@ -0,0 +1,266 @@
+/*=========================================================================
+
+  Name:        vtkDeviceOneEuroFilter.cxx
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0.
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+=========================================================================*/
+
+#include "vtkDeviceOneEuroFilter.h"
+
+#include "vtkObjectFactory.h"
+#include "vtkstd/vector"
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VTK_DEVICE_ONE_EURO_FILTER_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+class vtkDeviceOneEuroFilterInternals
+{
+public:
+  vtkDeviceOneEuroFilterInternals()
+    {
+    this->Initialized = false;
+    this->LastTime = 0.0;
+    }
+
+  // Parameters per channel
+  vtkstd::vector<double> MinimumCutoff;
+  vtkstd::vector<double> Beta;
+  vtkstd::vector<double> DerivativeCutoff;
+
+  // Filtered value and speed per channel
+  vtkstd::vector<double> Value;
+  vtkstd::vector<double> Derivative;
+
+  bool Initialized;
+  double LastTime;
+};
+
+vtkCxxRevisionMacro(vtkDeviceOneEuroFilter, "$Revision: 1.0 $");
+vtkStandardNewMacro(vtkDeviceOneEuroFilter);
+
+//----------------------------------------------------------------------------
+vtkDeviceOneEuroFilter::vtkDeviceOneEuroFilter()
+{
+  this->Internals = new vtkDeviceOneEuroFilterInternals();
+
+  this->MinimumCutoff = 1.0;
+  this->Beta = 0.0;
+  this->DerivativeCutoff = 1.0;
+  this->Tolerance = 1.0e-6;
+}
+
+//----------------------------------------------------------------------------
+vtkDeviceOneEuroFilter::~vtkDeviceOneEuroFilter()
+{
+  delete this->Internals;
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceOneEuroFilter::SetNumberOfChannels(int num)
+{
+  if (num < 0) num = 0;
+  if (num == this->GetNumberOfChannels()) return;
+
+  this->Internals->MinimumCutoff.resize(num, this->MinimumCutoff);
+  this->Internals->Beta.resize(num, this->Beta);
+  this->Internals->DerivativeCutoff.resize(num, this->DerivativeCutoff);
+  this->Internals->Value.resize(num, 0.0);
+  this->Internals->Derivative.resize(num, 0.0);
+
+  this->Reset();
+}
+
+//----------------------------------------------------------------------------
+int vtkDeviceOneEuroFilter::GetNumberOfChannels()
+{
+  return this->Internals->Value.size();
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceOneEuroFilter::SetMinimumCutoff(int channel, double cutoff)
+{
+  this->Internals->MinimumCutoff[channel] = cutoff;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+double vtkDeviceOneEuroFilter::GetMinimumCutoff(int channel)
+{
+  return this->Internals->MinimumCutoff[channel];
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceOneEuroFilter::SetBeta(int channel, double beta)
+{
+  this->Internals->Beta[channel] = beta;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+double vtkDeviceOneEuroFilter::GetBeta(int channel)
+{
+  return this->Internals->Beta[channel];
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceOneEuroFilter::SetDerivativeCutoff(int channel, double cutoff)
+{
+  this->Internals->DerivativeCutoff[channel] = cutoff;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+double vtkDeviceOneEuroFilter::GetDerivativeCutoff(int channel)
+{
+  return this->Internals->DerivativeCutoff[channel];
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceOneEuroFilter::SetMinimumCutoff(double cutoff)
+{
+  this->MinimumCutoff = cutoff;
+  this->Internals->MinimumCutoff.assign(this->Internals->MinimumCutoff.size(), cutoff);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceOneEuroFilter::SetBeta(double beta)
+{
+  this->Beta = beta;
+  this->Internals->Beta.assign(this->Internals->Beta.size(), beta);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceOneEuroFilter::SetDerivativeCutoff(double cutoff)
+{
+  this->DerivativeCutoff = cutoff;
+  this->Internals->DerivativeCutoff.assign(this->Internals->DerivativeCutoff.size(), cutoff);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceOneEuroFilter::Reset()
+{
+  this->Internals->Initialized = false;
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceOneEuroFilter::Filter(double time, const double* values, double* filtered)
+{
+  int num = this->GetNumberOfChannels();
+  if (num == 0) return;
+
+  double* value = &this->Internals->Value[0];
+  double* derivative = &this->Internals->Derivative[0];
+
+  double dt = time - this->Internals->LastTime;
+
+  if (!this->Internals->Initialized)
+    {
+    // Start from the first sample
+    for (int i = 0; i < num; i++)
+      {
+      value[i] = values[i];
+      derivative[i] = 0.0;
+      filtered[i] = values[i];
+      }
+
+    this->Internals->Initialized = true;
+    this->Internals->LastTime = time;
+
+    return;
+    }
+  else if (dt <= 0.0)
+    {
+    // No time has passed, so keep the last values
+    for (int i = 0; i < num; i++) filtered[i] = value[i];
+
+    return;
+    }
+
+  this->Internals->LastTime = time;
+
+  // The smoothing factor for cutoff frequency c is r / (1 + r), with
+  // r = 2 pi c dt
+  const double* minimumCutoff = &this->Internals->MinimumCutoff[0];
+  const double* beta = &this->Internals->Beta[0];
+  const double* derivativeCutoff = &this->Internals->DerivativeCutoff[0];
+  double twoPiDt = 2.0 * 3.14159265358979323846 * dt;
+  double rate = 1.0 / dt;
+
+  int i = 0;
+
+#ifdef VTK_DEVICE_ONE_EURO_FILTER_USE_SSE2
+  // Filter two channels at a time
+  const __m128d twoPiDt2 = _mm_set1_pd(twoPiDt);
+  const __m128d rate2 = _mm_set1_pd(rate);
+  const __m128d one = _mm_set1_pd(1.0);
+  const __m128d signMask = _mm_set1_pd(-0.0);
+
+  for (; i + 1 < num; i += 2)
+    {
+    __m128d x = _mm_loadu_pd(values + i);
+    __m128d v = _mm_loadu_pd(value + i);
+    __m128d d = _mm_loadu_pd(derivative + i);
+
+    // Smooth the speed
+    __m128d dx = _mm_mul_pd(_mm_sub_pd(x, v), rate2);
+    __m128d r = _mm_mul_pd(twoPiDt2, _mm_loadu_pd(derivativeCutoff + i));
+    __m128d a = _mm_div_pd(r, _mm_add_pd(one, r));
+    d = _mm_add_pd(d, _mm_mul_pd(a, _mm_sub_pd(dx, d)));
+
+    // Raise the cutoff with the speed and smooth the value
+    __m128d cutoff = _mm_add_pd(_mm_loadu_pd(minimumCutoff + i),
+                                _mm_mul_pd(_mm_loadu_pd(beta + i), _mm_andnot_pd(signMask, d)));
+    r = _mm_mul_pd(twoPiDt2, cutoff);
+    a = _mm_div_pd(r, _mm_add_pd(one, r));
+    v = _mm_add_pd(v, _mm_mul_pd(a, _mm_sub_pd(x, v)));
+
+    _mm_storeu_pd(derivative + i, d);
+    _mm_storeu_pd(value + i, v);
+    _mm_storeu_pd(filtered + i, v);
+    }
+#endif
+
+  for (; i < num; i++)
+    {
+    double x = values[i];
+
+    // Smooth the speed
+    double dx = (x - value[i]) * rate;
+    double r = twoPiDt * derivativeCutoff[i];
+    derivative[i] += r / (1.0 + r) * (dx - derivative[i]);
+
+    // Raise the cutoff with the speed and smooth the value
+    r = twoPiDt * (minimumCutoff[i] + beta[i] * fabs(derivative[i]));
+    value[i] += r / (1.0 + r) * (x - value[i]);
+
+    filtered[i] = value[i];
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceOneEuroFilter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "NumberOfChannels: " << this->GetNumberOfChannels() << "\n";
+  os << indent << "MinimumCutoff: " << this->MinimumCutoff << "\n";
+  os << indent << "Beta: " << this->Beta << "\n";
+  os << indent << "DerivativeCutoff: " << this->DerivativeCutoff << "\n";
+  os << indent << "Tolerance: " << this->Tolerance << "\n";
+}
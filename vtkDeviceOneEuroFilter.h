@@ -0,0 +1,109 @@
+/*=========================================================================
+
+  Name:        vtkDeviceOneEuroFilter.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0.
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+=========================================================================*/
+// .NAME vtkDeviceOneEuroFilter
+// .SECTION Description
+// vtkDeviceOneEuroFilter is an adaptive low-pass filter for noisy device
+// values, using the 1 Euro filter of Casiez et al.  The cutoff frequency
+// rises with the speed of each value, so slow movements are smoothed to
+// remove jitter, and fast movements are followed with little lag.  Any
+// number of channels are filtered at once, each with its own parameters.
+// Memory is only allocated when the number of channels changes.  Set it on
+// a vtkVRPNTracker or vtkVRPNAnalog to filter their values, or call
+// Filter() directly, e.g. on touch point locations.
+
+// .SECTION see also
+// vtkVRPNTracker vtkVRPNAnalog
+
+#ifndef __vtkDeviceOneEuroFilter_h
+#define __vtkDeviceOneEuroFilter_h
+
+#include "vtkInteractionDeviceConfigure.h"
+
+#include "vtkObject.h"
+
+// Holds vtkstd member variables, which must be hidden
+class vtkDeviceOneEuroFilterInternals;
+
+class VTK_INTERACTIONDEVICE_EXPORT vtkDeviceOneEuroFilter : public vtkObject
+{
+public:
+  static vtkDeviceOneEuroFilter* New();
+  vtkTypeRevisionMacro(vtkDeviceOneEuroFilter,vtkObject);
+  void PrintSelf(ostream&, vtkIndent);
+
+  // Description:
+  // The number of channels to filter.  New channels get the parameters set
+  // for all channels, and the filter is reset.
+  void SetNumberOfChannels(int num);
+  int GetNumberOfChannels();
+
+  // Description:
+  // Cutoff frequency in Hz when the value is not moving.  Lower values
+  // remove more jitter but lag more.  Default is 1.0.
+  void SetMinimumCutoff(int channel, double cutoff);
+  double GetMinimumCutoff(int channel);
+
+  // Description:
+  // How much the cutoff frequency rises with speed.  Higher values lag
+  // less during fast movements.  Default is 0.0, a fixed cutoff.
+  void SetBeta(int channel, double beta);
+  double GetBeta(int channel);
+
+  // Description:
+  // Cutoff frequency in Hz for the speed estimate.  Default is 1.0.
+  void SetDerivativeCutoff(int channel, double cutoff);
+  double GetDerivativeCutoff(int channel);
+
+  // Description:
+  // Set a parameter for all channels, including channels added later
+  void SetMinimumCutoff(double cutoff);
+  void SetBeta(double beta);
+  void SetDerivativeCutoff(double cutoff);
+
+  // Description:
+  // Filtered values within this distance of their input are considered
+  // settled.  Used by devices to keep updating values that are still
+  // catching up after their input stopped changing.  Default is 1e-6.
+  vtkSetMacro(Tolerance,double);
+  vtkGetMacro(Tolerance,double);
+
+  // Description:
+  // Filter one sample of every channel, taken at the given time in
+  // seconds.  values and filtered hold GetNumberOfChannels() values, and
+  // may be the same.  The first sample after a reset is passed through.
+  void Filter(double time, const double* values, double* filtered);
+
+  // Description:
+  // Forget the previous samples
+  void Reset();
+
+protected:
+  vtkDeviceOneEuroFilter();
+  ~vtkDeviceOneEuroFilter();
+
+  double MinimumCutoff;
+  double Beta;
+  double DerivativeCutoff;
+  double Tolerance;
+
+  vtkDeviceOneEuroFilterInternals* Internals;
+
+private:
+  vtkDeviceOneEuroFilter(const vtkDeviceOneEuroFilter&);  // Not implemented.
+  void operator=(const vtkDeviceOneEuroFilter&);  // Not implemented.
+};
+
+#endif
@@ -0,0 +1,141 @@
+/*=========================================================================
+
+  Name:        vtkDeviceViewTransform.cxx
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0.
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+=========================================================================*/
+
+#include "vtkDeviceViewTransform.h"
+
+#include "vtkCamera.h"
+#include "vtkMatrix4x4.h"
+#include "vtkObjectFactory.h"
+#include "vtkRenderer.h"
+#include "vtkRenderWindow.h"
+
+vtkCxxRevisionMacro(vtkDeviceViewTransform, "$Revision: 1.0 $");
+vtkStandardNewMacro(vtkDeviceViewTransform);
+
+//----------------------------------------------------------------------------
+vtkDeviceViewTransform::vtkDeviceViewTransform()
+{
+  this->Renderer = NULL;
+
+  for (int i = 0; i < 16; i++)
+    {
+    this->Matrix[i] = i % 5 == 0 ? 1.0 : 0.0;
+    this->InverseMatrix[i] = this->Matrix[i];
+    }
+
+  this->DisplayScale[0] = this->DisplayScale[1] = 1.0;
+  this->DisplayOrigin[0] = this->DisplayOrigin[1] = 0.0;
+
+  this->Camera = NULL;
+  this->CameraMTime = 0;
+  this->AspectRatio = 0.0;
+  for (int i = 0; i < 4; i++) this->Viewport[i] = 0.0;
+  this->WindowSize[0] = this->WindowSize[1] = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkDeviceViewTransform::~vtkDeviceViewTransform()
+{
+  this->SetRenderer(NULL);
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceViewTransform::SetRenderer(vtkRenderer* renderer)
+{  
+  if (this->Renderer == renderer)
+    {
+    return;
+    }
+
+  if (this->Renderer != NULL) 
+    {
+    this->Renderer->UnRegister(this);
+    }
+
+  this->Renderer = renderer;
+
+  if (this->Renderer != NULL) 
+    {
+    this->Renderer->Register(this);
+    }
+
+  // Force the next Update() to recompute
+  this->Camera = NULL;
+
+  this->Modified();
+} 
+
+//----------------------------------------------------------------------------
+int vtkDeviceViewTransform::Update()
+{
+  if (!this->Renderer || !this->Renderer->GetRenderWindow()) return 0;
+
+  vtkCamera* camera = this->Renderer->GetActiveCamera();
+  double aspect = this->Renderer->GetTiledAspectRatio();
+  double* viewport = this->Renderer->GetViewport();
+  int* size = this->Renderer->GetRenderWindow()->GetSize();
+  if (!camera || !size) return 0;
+
+  if (camera == this->Camera && 
+      camera->GetMTime() == this->CameraMTime &&
+      aspect == this->AspectRatio &&
+      viewport[0] == this->Viewport[0] && viewport[1] == this->Viewport[1] &&
+      viewport[2] == this->Viewport[2] && viewport[3] == this->Viewport[3] &&
+      size[0] == this->WindowSize[0] && size[1] == this->WindowSize[1])
+    {
+    return 0;
+    }
+
+  // Same matrix as vtkRenderer::WorldToView() and ViewToWorld()
+  vtkMatrix4x4* matrix = camera->GetCompositeProjectionTransformMatrix(aspect, 0, 1);
+  for (int i = 0; i < 4; i++)
+    {
+    for (int j = 0; j < 4; j++)
+      {
+      this->Matrix[i * 4 + j] = matrix->Element[i][j];
+      }
+    }
+  vtkMatrix4x4::Invert(this->Matrix, this->InverseMatrix);
+
+  // Same mapping as vtkViewport::ViewToDisplay() and DisplayToView()
+  for (int i = 0; i < 2; i++)
+    {
+    this->DisplayScale[i] = size[i] * (viewport[i + 2] - viewport[i]) / 2.0;
+    this->DisplayOrigin[i] = size[i] * viewport[i];
+    if (this->DisplayScale[i] == 0.0) this->DisplayScale[i] = 1.0;
+    }
+
+  this->Camera = camera;
+  this->CameraMTime = camera->GetMTime();
+  this->AspectRatio = aspect;
+  for (int i = 0; i < 4; i++) this->Viewport[i] = viewport[i];
+  this->WindowSize[0] = size[0];
+  this->WindowSize[1] = size[1];
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkDeviceViewTransform::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Renderer: " << this->Renderer << "\n";
+  os << indent << "AspectRatio: " << this->AspectRatio << "\n";
+  os << indent << "Viewport: (" << this->Viewport[0] << ", " << this->Viewport[1] << ", "
+     << this->Viewport[2] << ", " << this->Viewport[3] << ")\n";
+  os << indent << "WindowSize: (" << this->WindowSize[0] << ", " << this->WindowSize[1] << ")\n";
+}
@@ -0,0 +1,128 @@
+/*=========================================================================
+
+  Name:        vtkDeviceViewTransform.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0.
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+=========================================================================*/
+// .NAME vtkDeviceViewTransform
+// .SECTION Description
+// vtkDeviceViewTransform converts points between world and display
+// coordinates for a renderer, giving the same results as 
+// vtkInteractorObserver::ComputeWorldToDisplay() and 
+// ComputeDisplayToWorld().  Those get the composite projection matrix from
+// the camera, and invert it, on every call.  Here the matrix and its 
+// inverse are cached, and Update() only recomputes them when the camera,
+// its aspect ratio, the viewport, or the window size has changed, so each
+// conversion is a single matrix multiply.  Styles using the same renderer
+// can share one with vtkDeviceInteractorStyle::SetViewTransform().
+
+// .SECTION see also
+// vtkDeviceInteractorStyle
+
+#ifndef __vtkDeviceViewTransform_h
+#define __vtkDeviceViewTransform_h
+
+#include "vtkInteractionDeviceConfigure.h"
+
+#include "vtkObject.h"
+
+class vtkCamera;
+class vtkRenderer;
+
+class VTK_INTERACTIONDEVICE_EXPORT vtkDeviceViewTransform : public vtkObject
+{
+public:
+  static vtkDeviceViewTransform* New();
+  vtkTypeRevisionMacro(vtkDeviceViewTransform,vtkObject);
+  void PrintSelf(ostream&, vtkIndent);
+
+  // Description:
+  // Set the renderer whose active camera and viewport are used
+  void SetRenderer(vtkRenderer* renderer);
+  vtkGetObjectMacro(Renderer,vtkRenderer);
+
+  // Description:
+  // Recompute the cached matrices if the camera or viewport has changed 
+  // since the last call.  Call before converting points.  Returns 1 if
+  // they were recomputed.
+  int Update();
+
+  // Description:
+  // Convert a point from world to display coordinates.  The display z is
+  // the depth in the range [0, 1].
+  void WorldToDisplay(double x, double y, double z, double display[3])
+    {
+    const double* m = this->Matrix;
+    double vx = m[0] * x + m[1] * y + m[2] * z + m[3];
+    double vy = m[4] * x + m[5] * y + m[6] * z + m[7];
+    double vz = m[8] * x + m[9] * y + m[10] * z + m[11];
+    double w = m[12] * x + m[13] * y + m[14] * z + m[15];
+    if (w != 0.0)
+      {
+      vx /= w;
+      vy /= w;
+      vz /= w;
+      }
+
+    display[0] = (vx + 1.0) * this->DisplayScale[0] + this->DisplayOrigin[0];
+    display[1] = (vy + 1.0) * this->DisplayScale[1] + this->DisplayOrigin[1];
+    display[2] = vz;
+    }
+
+  // Description:
+  // Convert a point from display to world coordinates
+  void DisplayToWorld(double x, double y, double z, double world[3])
+    {
+    double vx = (x - this->DisplayOrigin[0]) / this->DisplayScale[0] - 1.0;
+    double vy = (y - this->DisplayOrigin[1]) / this->DisplayScale[1] - 1.0;
+
+    const double* m = this->InverseMatrix;
+    world[0] = m[0] * vx + m[1] * vy + m[2] * z + m[3];
+    world[1] = m[4] * vx + m[5] * vy + m[6] * z + m[7];
+    world[2] = m[8] * vx + m[9] * vy + m[10] * z + m[11];
+    double w = m[12] * vx + m[13] * vy + m[14] * z + m[15];
+    if (w != 0.0)
+      {
+      world[0] /= w;
+      world[1] /= w;
+      world[2] /= w;
+      }
+    }
+
+protected:
+  vtkDeviceViewTransform();
+  ~vtkDeviceViewTransform();
+
+  vtkRenderer* Renderer;
+
+  // Composite projection matrix and its inverse, row-major
+  double Matrix[16];
+  double InverseMatrix[16];
+
+  // Maps view coordinates in [-1, 1] to display coordinates
+  double DisplayScale[2];
+  double DisplayOrigin[2];
+
+  // What the matrices were computed from.  The camera is only compared, 
+  // never dereferenced, so it is not registered.
+  vtkCamera* Camera;
+  unsigned long CameraMTime;
+  double AspectRatio;
+  double Viewport[4];
+  int WindowSize[2];
+
+private:
+  vtkDeviceViewTransform(const vtkDeviceViewTransform&);  // Not implemented.
+  void operator=(const vtkDeviceViewTransform&);  // Not implemented.
+};
+
+#endif
@@ -21,6 +21,13 @@ vtkCxxRevisionMacro(vtkInteractionDevice, "$Revision: 1.0 $");
 //----------------------------------------------------------------------------
 vtkInteractionDevice::vtkInteractionDevice() 
 {
+  this->Threaded = 0;
+
+  this->BatchMode = 0;
+  this->BatchCapacity = 256;
+
+  this->ReportTime = 0.0;
+  this->ArrivalTime = 0.0;
 }
 
 //----------------------------------------------------------------------------
@@ -28,8 +35,40 @@ vtkInteractionDevice::~vtkInteractionDevice()
 {
 }
 
+//----------------------------------------------------------------------------
+void vtkInteractionDevice::SetThreaded(int threaded)
+{
+  if (this->Threaded == threaded)
+    {
+    return;
+    }
+
+  this->Threaded = threaded;
+
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkInteractionDevice::SetBatchMode(int batchMode)
+{
+  if (this->BatchMode == batchMode)
+    {
+    return;
+    }
+
+  this->BatchMode = batchMode;
+
+  this->Modified();
+}
+
 //----------------------------------------------------------------------------
 void vtkInteractionDevice::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Threaded: " << this->Threaded << "\n";
+  os << indent << "BatchMode: " << this->BatchMode << "\n";
+  os << indent << "BatchCapacity: " << this->BatchCapacity << "\n";
+  os << indent << "ReportTime: " << this->ReportTime << "\n";
+  os << indent << "ArrivalTime: " << this->ArrivalTime << "\n";
 }
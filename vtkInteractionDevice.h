@@ -48,10 +48,62 @@ public:
   // Invoke the appropriate event for observers to listen for
   virtual void InvokeInteractionEvent() = 0;
 
+  // Description:
+  // Return a file descriptor that becomes readable when the device has new 
+  // data, or -1 if the device cannot be waited on and must be polled.  Used
+  // by event loops that sleep until something happens.
+  virtual int GetFileDescriptor() { return -1; }
+
+  // Description:
+  // Support for the vtkDeviceInteractor polling thread.  When Threaded is
+  // on, Update() and PublishState() are called from the polling thread,
+  // and PublishState() hands the newest device state to the render
+  // thread without locking.  ConsumeState() is called from the render
+  // thread before InvokeInteractionEvent(), makes the newest published
+  // state visible to the get methods, and returns 1 if the interaction 
+  // event should be invoked, normally because new state has been published
+  // since the last call.  Devices only publish when they received new 
+  // reports.  Threaded is set by vtkDeviceInteractor.
+  virtual void SetThreaded(int threaded);
+  vtkGetMacro(Threaded,int);
+  virtual void PublishState() {}
+  virtual int ConsumeState() { return 1; }
+
+  // Description:
+  // Timestamps of the oldest new report delivered by the last call to 
+  // InvokeInteractionEvent(), in seconds, or 0 if no new reports were 
+  // delivered.  ReportTime is the time the device sent the report, if 
+  // known, and ArrivalTime the vtkTimerLog universal time it was received. 
+  // Used by vtkDeviceInteractor to measure input latency.
+  vtkGetMacro(ReportTime,double);
+  vtkGetMacro(ArrivalTime,double);
+
+  // Description:
+  // In batch mode, devices that support it keep every report received 
+  // since the last interaction event in a preallocated buffer of 
+  // BatchCapacity reports, and invoke an additional batch event with all 
+  // of them before the usual event for the latest state.  If more than 
+  // BatchCapacity reports arrive between events, the oldest are dropped.
+  // Set BatchCapacity before turning batch mode on, and change either only
+  // while the vtkDeviceInteractor polling thread is stopped.
+  virtual void SetBatchMode(int batchMode);
+  vtkGetMacro(BatchMode,int);
+  vtkBooleanMacro(BatchMode,int);
+  vtkSetClampMacro(BatchCapacity,int,1,VTK_INT_MAX);
+  vtkGetMacro(BatchCapacity,int);
+
 protected:
   vtkInteractionDevice();
   ~vtkInteractionDevice();
 
+  int Threaded;
+
+  int BatchMode;
+  int BatchCapacity;
+
+  double ReportTime;
+  double ArrivalTime;
+
 private:
   vtkInteractionDevice(const vtkInteractionDevice&);  // Not implemented.
   void operator=(const vtkInteractionDevice&);  // Not implemented.
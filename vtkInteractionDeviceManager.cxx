@@ -40,9 +40,13 @@
 # define VTK_DISPLAY_COCOA
 #endif
 
-// X OpenGL stuff
+// X OpenGL stuff.  The device interactor is only built on Linux.
 #ifdef VTK_USE_OGLR
-# include "vtkXOpenGLRenderWindowDeviceInteractor.h"
+# ifdef vtkInteractionDevice_USE_X_INTERACTOR
+#  include "vtkXRenderWindowDeviceInteractor.h"
+# else
+#  include "vtkXRenderWindowInteractor.h"
+# endif
 # define VTK_DISPLAY_X11_OGL
 #endif
 
@@ -79,14 +83,23 @@ vtkRenderWindowInteractor* vtkInteractionDeviceManager::GetInteractor(vtkDeviceI
 #ifdef VTK_USE_OGLR
   if (!vtkGraphicsFactory::GetOffScreenOnlyMode())
     {
+# ifdef vtkInteractionDevice_USE_X_INTERACTOR
+    vtkXRenderWindowDeviceInteractor* interactor = vtkXRenderWindowDeviceInteractor::New();
+    interactor->SetDeviceInteractor(deviceInteractor);
+
+    return interactor;
+# else
     vtkErrorMacro(<<"Device interaction not implemented for this platform yet.");
     return vtkXRenderWindowInteractor::New();
+# endif
     }
 #endif
 
 #if defined(VTK_USE_OSMESA)
-  vtkErrorMacro(<<"Device interaction not implemented for this platform yet.");
-  return vtkRenderWindowInteractor::New();
+  vtkOSOpenGLRenderWindowDeviceInteractor* interactor = vtkOSOpenGLRenderWindowDeviceInteractor::New();
+  interactor->SetDeviceInteractor(deviceInteractor);
+
+  return interactor;
 #endif
 
 #ifdef VTK_DISPLAY_WIN32_OGL
@@ -0,0 +1,177 @@
+/*=========================================================================
+
+  Name:        vtkInteractionDeviceReportBuffer.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0.
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+=========================================================================*/
+// .NAME vtkInteractionDeviceReportBuffer
+// .SECTION Description
+// vtkInteractionDeviceReportBuffer is a preallocated, lock-free, single-
+// producer/single-consumer ring of device reports, used by interaction
+// devices in batch mode.  The writer calls Push() for every report
+// received, from either the render thread or the vtkDeviceInteractor
+// polling thread, and the reader calls Drain() once per frame to copy out
+// every report pushed since the last call, oldest first.  If the writer
+// gets more than the capacity ahead, the oldest reports are dropped and
+// counted.  Nothing is allocated after SetCapacity().  This is an internal
+// helper and is not wrapped.
+//
+// T must be trivially copyable, i.e. plain data without pointers to memory
+// it owns.  The reader may copy a report while the writer overwrites it,
+// and only drops such reports afterwards, so copying T must be safe while
+// it is being written.
+
+// .SECTION see also
+// vtkInteractionDeviceTripleBuffer vtkInteractionDevice
+
+#ifndef __vtkInteractionDeviceReportBuffer_h
+#define __vtkInteractionDeviceReportBuffer_h
+
+#include "vtkInteractionDeviceTripleBuffer.h"
+
+//BTX
+template <class T>
+class vtkInteractionDeviceReportBuffer
+{
+public:
+  vtkInteractionDeviceReportBuffer()
+    {
+    this->Reports = NULL;
+    this->Batch = NULL;
+    this->Capacity = 0;
+    this->Written = 0;
+    this->Read = 0;
+    this->NumberOfLostReports = 0;
+    }
+  ~vtkInteractionDeviceReportBuffer()
+    {
+    delete [] this->Reports;
+    delete [] this->Batch;
+    }
+
+  // Description:
+  // Allocate room for at least capacity reports and discard any reports.
+  // 0 frees the buffer.  Only call when no other thread is using the buffer.
+  void SetCapacity(int capacity)
+    {
+    delete [] this->Reports;
+    delete [] this->Batch;
+    this->Reports = NULL;
+    this->Batch = NULL;
+
+    this->Capacity = 0;
+    if (capacity > 0)
+      {
+      // One slot is kept free for the report being pushed, and a power of
+      // two keeps the indices continuous when the counters wrap around
+      this->Capacity = 1;
+      while (this->Capacity < static_cast<unsigned long>(capacity) + 1) this->Capacity <<= 1;
+
+      this->Reports = new T[this->Capacity];
+      this->Batch = new T[this->Capacity];
+      }
+
+    this->Written = 0;
+    this->Read = 0;
+    this->NumberOfLostReports = 0;
+    }
+  int GetCapacity()
+    {
+    return this->Capacity > 0 ? static_cast<int>(this->Capacity - 1) : 0;
+    }
+
+  // Description:
+  // Writer side.  Add a report.  Does nothing if there is no capacity.
+  void Push(const T& report)
+    {
+    if (this->Capacity == 0) return;
+
+    // Only the writer changes Written, so a plain read is safe here
+    unsigned long written = static_cast<unsigned long>(this->Written);
+    this->Reports[written & (this->Capacity - 1)] = report;
+
+    vtkInteractionDeviceAtomicExchange(&this->Written, static_cast<long>(written + 1));
+    }
+
+  // Description:
+  // Reader side.  Copy all reports pushed since the last call into the
+  // batch, and return how many there are.  The batch stays valid until the
+  // next call, and belongs to the reader, so it may be modified in place.
+  int Drain()
+    {
+    if (this->Capacity == 0) return 0;
+
+    unsigned long written = static_cast<unsigned long>(vtkInteractionDeviceAtomicLoad(&this->Written));
+    unsigned long first = this->Read;
+
+    // Unsigned differences are correct across wrap-around
+    if (written - first > this->Capacity - 1)
+      {
+      this->NumberOfLostReports += written - first - (this->Capacity - 1);
+      first = written - (this->Capacity - 1);
+      }
+
+    unsigned long count = 0;
+    for (unsigned long i = first; i != written; i++)
+      {
+      this->Batch[count++] = this->Reports[i & (this->Capacity - 1)];
+      }
+
+    // Reports the writer overwrote while they were being copied may be
+    // torn, so drop them.  This includes the slot of the report being
+    // pushed right now, which has not been counted in Written yet.
+    unsigned long after = static_cast<unsigned long>(vtkInteractionDeviceAtomicLoad(&this->Written)) + 1;
+    unsigned long overwritten = after - first > this->Capacity ? after - first - this->Capacity : 0;
+    if (overwritten > count) overwritten = count;
+    if (overwritten > 0)
+      {
+      for (unsigned long i = overwritten; i < count; i++)
+        {
+        this->Batch[i - overwritten] = this->Batch[i];
+        }
+      count -= overwritten;
+      this->NumberOfLostReports += overwritten;
+      }
+
+    this->Read = written;
+
+    return static_cast<int>(count);
+    }
+  T* GetBatch()
+    {
+    return this->Batch;
+    }
+
+  // Description:
+  // Reports dropped because the reader fell too far behind.  Reader side.
+  unsigned long GetNumberOfLostReports()
+    {
+    return this->NumberOfLostReports;
+    }
+
+private:
+  T* Reports;
+  T* Batch;
+  unsigned long Capacity;
+
+  // Written is only changed by the writer, and Read and Batch are only
+  // touched by the reader
+  volatile long Written;
+  unsigned long Read;
+  unsigned long NumberOfLostReports;
+
+  vtkInteractionDeviceReportBuffer(const vtkInteractionDeviceReportBuffer&);  // Not implemented.
+  void operator=(const vtkInteractionDeviceReportBuffer&);  // Not implemented.
+};
+//ETX
+
+#endif
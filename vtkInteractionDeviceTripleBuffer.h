@@ -0,0 +1,149 @@
+/*=========================================================================
+
+  Name:        vtkInteractionDeviceTripleBuffer.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0.
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+=========================================================================*/
+// .NAME vtkInteractionDeviceTripleBuffer
+// .SECTION Description
+// vtkInteractionDeviceTripleBuffer is a lock-free, single-producer/
+// single-consumer triple buffer used to hand device state from the
+// vtkDeviceInteractor polling thread to the render thread.  The writer
+// fills the back buffer and calls Publish(); the reader calls Consume()
+// and then reads the front buffer.  Neither side ever blocks, and the
+// reader always sees the newest complete state that has been published.
+// This is an internal helper and is not wrapped.
+
+// .SECTION see also
+// vtkDeviceInteractor vtkInteractionDevice
+
+#ifndef __vtkInteractionDeviceTripleBuffer_h
+#define __vtkInteractionDeviceTripleBuffer_h
+
+#ifdef _WIN32
+# include "vtkWindows.h"
+#endif
+
+//BTX
+// Description:
+// Atomic exchange, load and add with full memory barriers
+inline long vtkInteractionDeviceAtomicExchange(volatile long* target, long value)
+{
+#if defined(_WIN32)
+  return InterlockedExchange(target, value);
+#elif defined(__GNUC__)
+  // __sync_lock_test_and_set() is only an acquire barrier
+  __sync_synchronize();
+  return __sync_lock_test_and_set(target, value);
+#else
+# error "No atomic operations available for this compiler"
+#endif
+}
+
+inline long vtkInteractionDeviceAtomicLoad(volatile long* target)
+{
+#if defined(_WIN32)
+  return InterlockedCompareExchange(target, 0, 0);
+#elif defined(__GNUC__)
+  return __sync_fetch_and_add(target, 0);
+#else
+# error "No atomic operations available for this compiler"
+#endif
+}
+
+// Returns the value before adding
+inline long vtkInteractionDeviceAtomicAdd(volatile long* target, long value)
+{
+#if defined(_WIN32)
+  return InterlockedExchangeAdd(target, value);
+#elif defined(__GNUC__)
+  return __sync_fetch_and_add(target, value);
+#else
+# error "No atomic operations available for this compiler"
+#endif
+}
+
+template <class T>
+class vtkInteractionDeviceTripleBuffer
+{
+public:
+  vtkInteractionDeviceTripleBuffer()
+    {
+    this->Back = 0;
+    this->Middle = 1;
+    this->Front = 2;
+    }
+
+  // Description:
+  // Set all three buffers.  Only call when no other thread is using the buffer.
+  void Reset(const T& value)
+    {
+    for (int i = 0; i < 3; i++)
+      {
+      this->Buffers[i] = value;
+      }
+    this->Back = 0;
+    this->Middle = 1;
+    this->Front = 2;
+    }
+
+  // Description:
+  // Writer side.  Fill the back buffer, then publish it.
+  T& GetBackBuffer()
+    {
+    return this->Buffers[this->Back];
+    }
+  void Publish()
+    {
+    this->Back = vtkInteractionDeviceAtomicExchange(&this->Middle, this->Back | NewData) & IndexMask;
+    }
+
+  // Description:
+  // Reader side.  Consume() returns true if a new buffer was published
+  // since the last call, in which case it becomes the front buffer.
+  bool Consume()
+    {
+    if (!(vtkInteractionDeviceAtomicLoad(&this->Middle) & NewData))
+      {
+      return false;
+      }
+
+    this->Front = vtkInteractionDeviceAtomicExchange(&this->Middle, this->Front) & IndexMask;
+
+    return true;
+    }
+  T& GetFrontBuffer()
+    {
+    return this->Buffers[this->Front];
+    }
+
+private:
+  enum
+    {
+    IndexMask = 0x3,
+    NewData = 0x4
+    };
+
+  T Buffers[3];
+
+  // Back is only touched by the writer, Front only by the reader, and
+  // Middle is exchanged atomically between them.
+  long Back;
+  volatile long Middle;
+  long Front;
+
+  vtkInteractionDeviceTripleBuffer(const vtkInteractionDeviceTripleBuffer&);  // Not implemented.
+  void operator=(const vtkInteractionDeviceTripleBuffer&);  // Not implemented.
+};
+//ETX
+
+#endif
@@ -0,0 +1,229 @@
+/*=========================================================================
+
+  Name:        vtkOSOpenGLRenderWindowDeviceInteractor.cxx
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0.
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+=========================================================================*/
+
+#include "vtkOSOpenGLRenderWindowDeviceInteractor.h"
+
+#include "vtkCommand.h"
+#include "vtkObjectFactory.h"
+#include "vtkPNGWriter.h"
+#include "vtkRenderWindow.h"
+#include "vtkTimerLog.h"
+#include "vtkWindowToImageFilter.h"
+
+#include <stdio.h>
+
+vtkCxxRevisionMacro(vtkOSOpenGLRenderWindowDeviceInteractor, "$Revision: 1.0 $");
+vtkStandardNewMacro(vtkOSOpenGLRenderWindowDeviceInteractor);
+
+//----------------------------------------------------------------------------
+vtkOSOpenGLRenderWindowDeviceInteractor::vtkOSOpenGLRenderWindowDeviceInteractor()
+{
+  this->DeviceInteractor = NULL;
+
+  this->TargetFrameRate = 60.0;
+  this->MaximumNumberOfFrames = 0;
+  this->RenderAllFrames = 0;
+
+  this->WriteFrames = 0;
+  this->FilePrefix = NULL;
+  this->SetFilePrefix("frame");
+
+  this->Done = 0;
+
+  this->NumberOfFrames = 0;
+  this->LastFrameTime = 0.0;
+  this->MaximumFrameTime = 0.0;
+  this->TotalFrameTime = 0.0;
+
+  this->WindowToImage = NULL;
+  this->Writer = NULL;
+}
+
+//----------------------------------------------------------------------
+vtkOSOpenGLRenderWindowDeviceInteractor::~vtkOSOpenGLRenderWindowDeviceInteractor()
+{
+  this->SetDeviceInteractor(NULL);
+  this->SetFilePrefix(NULL);
+
+  if (this->WindowToImage) this->WindowToImage->Delete();
+  if (this->Writer) this->Writer->Delete();
+}
+
+//----------------------------------------------------------------------
+void vtkOSOpenGLRenderWindowDeviceInteractor::Start()
+{
+  // Let the compositing handle the event loop if it wants to.
+  if (this->HasObserver(vtkCommand::StartEvent) && !this->HandleEventLoop)
+    {
+    this->InvokeEvent(vtkCommand::StartEvent,NULL);
+    return;
+    }
+
+  if (!this->Initialized)
+    {
+    this->Initialize();
+    }
+  if (!this->Initialized)
+    {
+    return;
+    }
+
+  this->NumberOfFrames = 0;
+  this->LastFrameTime = 0.0;
+  this->MaximumFrameTime = 0.0;
+  this->TotalFrameTime = 0.0;
+
+  this->Done = 0;
+  while (!this->Done)
+    {
+    double frameStart = vtkTimerLog::GetUniversalTime();
+
+    // Receive updates from interaction devices.  The first frame is always
+    // rendered, after that only frames where a device changed the scene.
+    int dirty = this->NumberOfFrames == 0;
+    if (this->DeviceInteractor && this->DeviceInteractor->Update())
+      {
+      dirty = 1;
+      }
+
+    if (dirty || this->RenderAllFrames)
+      {
+      if (this->DeviceInteractor) this->DeviceInteractor->BeginRender();
+      this->Render();
+      if (this->DeviceInteractor) this->DeviceInteractor->EndRender();
+
+      double frameEnd = vtkTimerLog::GetUniversalTime();
+
+      if (this->WriteFrames)
+        {
+        this->WriteFrame();
+        }
+
+      // Statistics
+      this->LastFrameTime = frameEnd - frameStart;
+      this->TotalFrameTime += this->LastFrameTime;
+      if (this->LastFrameTime > this->MaximumFrameTime)
+        {
+        this->MaximumFrameTime = this->LastFrameTime;
+        }
+      this->NumberOfFrames++;
+      }
+
+    if (this->MaximumNumberOfFrames > 0 &&
+        this->NumberOfFrames >= this->MaximumNumberOfFrames)
+      {
+      break;
+      }
+
+    // Wait for the next frame
+    if (this->TargetFrameRate > 0.0)
+      {
+      double remaining = frameStart + 1.0 / this->TargetFrameRate -
+                         vtkTimerLog::GetUniversalTime();
+      if (remaining > 0.0)
+        {
+        vtkDeviceInteractor::Sleep(remaining);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------
+void vtkOSOpenGLRenderWindowDeviceInteractor::TerminateApp()
+{
+  this->Done = 1;
+}
+
+//----------------------------------------------------------------------
+double vtkOSOpenGLRenderWindowDeviceInteractor::GetAverageFrameTime()
+{
+  if (this->NumberOfFrames == 0) return 0.0;
+
+  return this->TotalFrameTime / this->NumberOfFrames;
+}
+
+//----------------------------------------------------------------------
+void vtkOSOpenGLRenderWindowDeviceInteractor::WriteFrame()
+{
+  if (!this->RenderWindow || !this->FilePrefix) return;
+
+  // Create the pipeline once and reuse it for every frame
+  if (!this->WindowToImage)
+    {
+    this->WindowToImage = vtkWindowToImageFilter::New();
+    this->WindowToImage->ReadFrontBufferOff();
+
+    this->Writer = vtkPNGWriter::New();
+    this->Writer->SetInputConnection(this->WindowToImage->GetOutputPort());
+    }
+
+  this->WindowToImage->SetInput(this->RenderWindow);
+  this->WindowToImage->Modified();
+
+  char fileName[1024];
+  sprintf(fileName, "%.1000s_%05d.png", this->FilePrefix, this->NumberOfFrames);
+  this->Writer->SetFileName(fileName);
+  this->Writer->Write();
+}
+
+//----------------------------------------------------------------------------
+void vtkOSOpenGLRenderWindowDeviceInteractor::SetDeviceInteractor(vtkDeviceInteractor* interactor)
+{
+  if (this->DeviceInteractor == interactor)
+    {
+    return;
+    }
+
+  if (this->DeviceInteractor != NULL)
+    {
+    this->DeviceInteractor->UnRegister(this);
+    }
+
+  this->DeviceInteractor = interactor;
+
+  if (this->DeviceInteractor != NULL)
+    {
+    this->DeviceInteractor->Register(this);
+    }
+
+  this->Modified();
+}
+
+
+//----------------------------------------------------------------------------
+void vtkOSOpenGLRenderWindowDeviceInteractor::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "TargetFrameRate: " << this->TargetFrameRate << "\n";
+  os << indent << "MaximumNumberOfFrames: " << this->MaximumNumberOfFrames << "\n";
+  os << indent << "RenderAllFrames: " << this->RenderAllFrames << "\n";
+  os << indent << "WriteFrames: " << this->WriteFrames << "\n";
+  os << indent << "FilePrefix: " << (this->FilePrefix ? this->FilePrefix : "(none)") << "\n";
+  os << indent << "NumberOfFrames: " << this->NumberOfFrames << "\n";
+  os << indent << "LastFrameTime: " << this->LastFrameTime << "\n";
+  os << indent << "MaximumFrameTime: " << this->MaximumFrameTime << "\n";
+  os << indent << "AverageFrameTime: " << this->GetAverageFrameTime() << "\n";
+  os << indent << "DeviceInteractor: ";
+  if (this->DeviceInteractor)
+    {
+    this->DeviceInteractor->PrintSelf(os,indent.GetNextIndent());
+    }
+  else
+    {
+    os << "(none)\n";
+    }
+}
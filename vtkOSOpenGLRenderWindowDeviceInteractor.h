@@ -0,0 +1,130 @@
+/*=========================================================================
+
+  Name:        vtkOSOpenGLRenderWindowDeviceInteractor.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0.
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+=========================================================================*/
+// .NAME vtkOSOpenGLRenderWindowDeviceInteractor
+// .SECTION Description
+// vtkOSOpenGLRenderWindowDeviceInteractor adds interaction with external
+// devices to offscreen (OSMesa) render windows, which have no window
+// system events.  Start() runs a loop that updates the vtkDeviceInteractor
+// and renders at TargetFrameRate, optionally writing every frame to a PNG
+// file, until TerminateApp() is called or MaximumNumberOfFrames have been
+// rendered.  Frame time statistics can be used to benchmark the whole
+// input-to-pixel pipeline on headless machines.
+
+// .SECTION see also
+// vtkInteractionDeviceManager vtkInteractionDevice
+// vtkDeviceInteractorStyle
+
+#ifndef __vtkOSOpenGLRenderWindowDeviceInteractor_h
+#define __vtkOSOpenGLRenderWindowDeviceInteractor_h
+
+#include "vtkInteractionDeviceConfigure.h"
+
+#include "vtkRenderWindowInteractor.h"
+
+#include "vtkDeviceInteractor.h"
+
+class vtkPNGWriter;
+class vtkWindowToImageFilter;
+
+class VTK_INTERACTIONDEVICE_EXPORT vtkOSOpenGLRenderWindowDeviceInteractor : public vtkRenderWindowInteractor
+{
+public:
+  static vtkOSOpenGLRenderWindowDeviceInteractor* New();
+  vtkTypeRevisionMacro(vtkOSOpenGLRenderWindowDeviceInteractor,vtkRenderWindowInteractor);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // Run the device/render loop until TerminateApp() is called or
+  // MaximumNumberOfFrames frames have been rendered.  Loop iterations where
+  // no device changed the scene are not rendered or counted as frames 
+  // unless RenderAllFrames is on.
+  virtual void Start();
+
+  // Description:
+  // Break out of the loop started by Start()
+  virtual void TerminateApp();
+
+  // Description:
+  // Sets the device interactor to use
+  void SetDeviceInteractor(vtkDeviceInteractor* interactor);
+
+  // Description:
+  // Frames per second to render at.  0 renders as fast as possible.
+  vtkSetClampMacro(TargetFrameRate,double,0.0,VTK_DOUBLE_MAX);
+  vtkGetMacro(TargetFrameRate,double);
+
+  // Description:
+  // Stop after this many frames.  0 runs until TerminateApp() is called.
+  vtkSetClampMacro(MaximumNumberOfFrames,int,0,VTK_INT_MAX);
+  vtkGetMacro(MaximumNumberOfFrames,int);
+
+  // Description:
+  // Render every frame, even if no device changed the scene.  Useful for 
+  // benchmarking and for recording at a fixed frame rate.  Default is off.
+  vtkSetMacro(RenderAllFrames,int);
+  vtkGetMacro(RenderAllFrames,int);
+  vtkBooleanMacro(RenderAllFrames,int);
+
+  // Description:
+  // Write every rendered frame to FilePrefix_NNNNN.png
+  vtkSetMacro(WriteFrames,int);
+  vtkGetMacro(WriteFrames,int);
+  vtkBooleanMacro(WriteFrames,int);
+  vtkSetStringMacro(FilePrefix);
+  vtkGetStringMacro(FilePrefix);
+
+  // Description:
+  // Frame statistics for the last run of Start().  Frame time is measured
+  // from the start of the device update to the end of the render, and does
+  // not include the time spent waiting for the next frame.
+  vtkGetMacro(NumberOfFrames,int);
+  vtkGetMacro(LastFrameTime,double);
+  vtkGetMacro(MaximumFrameTime,double);
+  double GetAverageFrameTime();
+
+protected:
+  vtkOSOpenGLRenderWindowDeviceInteractor();
+  ~vtkOSOpenGLRenderWindowDeviceInteractor();
+
+  vtkDeviceInteractor* DeviceInteractor;
+
+  double TargetFrameRate;
+  int MaximumNumberOfFrames;
+  int RenderAllFrames;
+
+  int WriteFrames;
+  char* FilePrefix;
+
+  int Done;
+
+  int NumberOfFrames;
+  double LastFrameTime;
+  double MaximumFrameTime;
+  double TotalFrameTime;
+
+  vtkWindowToImageFilter* WindowToImage;
+  vtkPNGWriter* Writer;
+
+  // Description:
+  // Write the current frame
+  void WriteFrame();
+
+private:
+  vtkOSOpenGLRenderWindowDeviceInteractor(const vtkOSOpenGLRenderWindowDeviceInteractor&);  // Not implemented.
+  void operator=(const vtkOSOpenGLRenderWindowDeviceInteractor&);  // Not implemented.
+};
+
+#endif
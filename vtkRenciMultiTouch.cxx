@@ -16,15 +16,522 @@
 
 #include "vtkRenciMultiTouch.h"
 
+#include "vtkInteractionDeviceReportBuffer.h"
+#include "vtkInteractionDeviceTripleBuffer.h"
 #include "vtkObjectFactory.h"
+#include "vtkTimerLog.h"
 #include "vtkstd/string"
 #include "vtkstd/vector"
 
+#ifndef WIN32
+# include <arpa/inet.h>
+# include <errno.h>
+# include <fcntl.h>
+# include <netinet/in.h>
+# include <string.h>
+# include <sys/socket.h>
+# include <unistd.h>
+
+// Winsock names for the BSD socket calls
+# define closesocket close
+# define INVALID_SOCKET -1
+# define SOCKET_ERROR -1
+
+// Read many datagrams per system call
+# if defined(__linux__) && defined(MSG_WAITFORONE)
+#  define VTK_RENCI_MULTI_TOUCH_USE_RECVMMSG
+# endif
+#endif
+
+// Largest datagram read, taken from OSC MAX_UDP_PACKET_SIZE
+static const int MaximumDatagramSize = 16384;
+
+// Datagrams read per call to ReceiveDatagrams()
+static const int DatagramPoolSize = 32;
+
+// Structure to hold a gesture.  Plain data with a fixed capacity, so 
+// gestures are copied between buffers without allocating, and a gesture
+// the batch buffer copies while the polling thread overwrites it is only
+// torn, never corrupted.
+struct GestureInformation
+{
+  // Index of the gesture's name in the gesture table, or -1 for none
+  int GestureType;
+
+  TouchPoint TouchPoints[VTK_RENCI_MULTI_TOUCH_MAX_TOUCH_POINTS];
+  int NumberOfTouchPoints;
+
+  // When the gesture was received.  The datagrams carry no timestamp.
+  double ArrivalTime;
+};
+
+// Copy a gesture, only touching the touch points in use
+static void CopyGesture(GestureInformation& target, const GestureInformation& gesture)
+{
+  target.GestureType = gesture.GestureType;
+  target.NumberOfTouchPoints = gesture.NumberOfTouchPoints;
+  for (int i = 0; i < gesture.NumberOfTouchPoints; i++)
+    {
+    target.TouchPoints[i] = gesture.TouchPoints[i];
+    }
+  target.ArrivalTime = gesture.ArrivalTime;
+}
+
+// Merge next into gesture if they are movements of the same touch points.
+// Returns whether they were merged.
+static bool MergeGestures(GestureInformation& gesture, const GestureInformation& next)
+{
+  if (gesture.GestureType != next.GestureType ||
+      gesture.NumberOfTouchPoints != next.NumberOfTouchPoints)
+    {
+    return false;
+    }
+
+  for (int i = 0; i < gesture.NumberOfTouchPoints; i++)
+    {
+    if (gesture.TouchPoints[i].Id != next.TouchPoints[i].Id) return false;
+    }
+
+  // Directions are the movement since the previous datagram, so add them
+  // up.  Everything else is taken from the latest.
+  for (int i = 0; i < gesture.NumberOfTouchPoints; i++)
+    {
+    double direction[2] = { gesture.TouchPoints[i].Direction[0], 
+                            gesture.TouchPoints[i].Direction[1] };
+    gesture.TouchPoints[i] = next.TouchPoints[i];
+    gesture.TouchPoints[i].Direction[0] += direction[0];
+    gesture.TouchPoints[i].Direction[1] += direction[1];
+    }
+  gesture.ArrivalTime = next.ArrivalTime;
+
+  return true;
+}
+
+// Gestures in the order received, with consecutive movements of the same 
+// touch points merged.  Plain data with a fixed capacity, so it is handed
+// to the render thread without allocating.
+struct GestureQueue
+{
+  GestureInformation Gestures[VTK_RENCI_MULTI_TOUCH_MAX_QUEUED_GESTURES];
+  int NumberOfGestures;
+
+  // Datagrams merged into each gesture
+  int NumberOfMerged[VTK_RENCI_MULTI_TOUCH_MAX_QUEUED_GESTURES];
+
+  // Number of the first gesture, counting all gestures queued before it,
+  // so a gesture keeps its number while it is merged into and published
+  // again
+  long FirstNumber;
+
+  // Publication number, so the polling thread can tell when the render 
+  // thread has taken the queue
+  long Sequence;
+
+  // Start over, numbering after the gestures queued so far
+  void Clear()
+    {
+    this->FirstNumber += this->NumberOfGestures;
+    this->NumberOfGestures = 0;
+    }
+
+  // Add a gesture of numMerged datagrams, merging it into the last gesture
+  // if possible.  When full, the oldest gesture is dropped.
+  void Add(const GestureInformation& gesture, int numMerged)
+    {
+    int last = this->NumberOfGestures - 1;
+    if (last >= 0 && MergeGestures(this->Gestures[last], gesture))
+      {
+      this->NumberOfMerged[last] += numMerged;
+      return;
+      }
+
+    if (this->NumberOfGestures == VTK_RENCI_MULTI_TOUCH_MAX_QUEUED_GESTURES)
+      {
+      for (int i = 1; i < this->NumberOfGestures; i++)
+        {
+        CopyGesture(this->Gestures[i - 1], this->Gestures[i]);
+        this->NumberOfMerged[i - 1] = this->NumberOfMerged[i];
+        }
+      this->NumberOfGestures--;
+      this->FirstNumber++;
+      }
+
+    CopyGesture(this->Gestures[this->NumberOfGestures], gesture);
+    this->NumberOfMerged[this->NumberOfGestures] = numMerged;
+    this->NumberOfGestures++;
+    }
+
+  // Copy another queue, only touching the gestures in use
+  void Copy(const GestureQueue& queue)
+    {
+    for (int i = 0; i < queue.NumberOfGestures; i++)
+      {
+      CopyGesture(this->Gestures[i], queue.Gestures[i]);
+      this->NumberOfMerged[i] = queue.NumberOfMerged[i];
+      }
+    this->NumberOfGestures = queue.NumberOfGestures;
+    this->FirstNumber = queue.FirstNumber;
+    this->Sequence = queue.Sequence;
+    }
+};
+
+// Gesture names sent by the server, and the events invoked for them
+static const struct
+{
+  const char* Name;
+  unsigned long EventId;
+} BuiltInGestures[] = 
+{
+  { "one_touch", vtkRenciMultiTouch::OneTouchEvent },
+  { "one_drag", vtkRenciMultiTouch::OneDragEvent },
+  { "two_touch", vtkRenciMultiTouch::TwoTouchEvent },
+  { "two_drag", vtkRenciMultiTouch::TwoDragEvent },
+  { "three_touch", vtkRenciMultiTouch::ThreeTouchEvent },
+  { "three_drag", vtkRenciMultiTouch::ThreeDragEvent },
+  { "four_touch", vtkRenciMultiTouch::FourTouchEvent },
+  { "four_drag", vtkRenciMultiTouch::FourDragEvent },
+  { "five_touch", vtkRenciMultiTouch::FiveTouchEvent },
+  { "five_drag", vtkRenciMultiTouch::FiveDragEvent },
+  { "six_touch", vtkRenciMultiTouch::SixTouchEvent },
+  { "six_drag", vtkRenciMultiTouch::SixDragEvent },
+  { "zoom", vtkRenciMultiTouch::ZoomEvent },
+  { "translate_x", vtkRenciMultiTouch::TranslateXEvent },
+  { "translate_y", vtkRenciMultiTouch::TranslateYEvent },
+  { "translate_z", vtkRenciMultiTouch::TranslateZEvent },
+  { "about_X_axis", vtkRenciMultiTouch::RotateYEvent },
+  { "about_Y_axis", vtkRenciMultiTouch::RotateYEvent },
+  { "about_Z_axis", vtkRenciMultiTouch::RotateZEvent },
+  { "release", vtkRenciMultiTouch::ReleaseEvent }
+};
+
+// FNV-1a hash of a gesture name
+static unsigned int HashGestureName(const char* name, int length)
+{
+  unsigned int hash = 2166136261u;
+  for (int i = 0; i < length; i++)
+    {
+    hash ^= static_cast<unsigned char>(name[i]);
+    hash *= 16777619u;
+    }
+
+  return hash;
+}
+
+// Reads Open Sound Control data in place, checking every read against the
+// end of the buffer.  Numbers are big-endian, and strings are terminated 
+// and padded with nulls to a multiple of 4 bytes.
+class vtkRenciMultiTouchOSCReader
+{
+public:
+  vtkRenciMultiTouchOSCReader(const char* buffer, int numBytes)
+    {
+    this->Position = buffer;
+    this->End = buffer + numBytes;
+    this->TypeTags = NULL;
+    }
+
+  const char* GetPosition() { return this->Position; }
+  int GetRemaining() { return static_cast<int>(this->End - this->Position); }
+  bool AtEnd() { return this->Position >= this->End; }
+
+  bool Skip(int numBytes)
+    {
+    if (numBytes > this->GetRemaining()) return false;
+    this->Position += numBytes;
+    return true;
+    }
+
+  bool ReadString(const char** string, int* length)
+    {
+    const char* end = static_cast<const char*>(memchr(this->Position, '\0', this->GetRemaining()));
+    if (!end) return false;
+
+    *string = this->Position;
+    *length = static_cast<int>(end - this->Position);
+
+    // The padding may be cut off at the end of the message
+    int padded = (*length + 4) & ~3;
+    this->Position = padded < this->GetRemaining() ? this->Position + padded : this->End;
+    return true;
+    }
+
+  bool ReadInt(int* value)
+    {
+    unsigned char bytes[4];
+    if (!this->ReadBigEndian(bytes, 4)) return false;
+    memcpy(value, bytes, 4);
+    return true;
+    }
+
+  // Set the type tags following the comma, so arguments are checked
+  // against them.  Without type tags, arguments are read as asked.
+  void SetTypeTags(const char* tags) { this->TypeTags = tags; }
+
+  bool ReadStringArgument(const char** string, int* length)
+    {
+    char tag = this->NextTypeTag('s');
+    if (tag != 's') 
+      {
+      // Skip over other arguments
+      double value;
+      return tag != '\0' && this->ReadNumber(tag, &value) && 
+             this->ReadStringArgument(string, length);
+      }
+
+    return this->ReadString(string, length);
+    }
+
+  bool ReadIntArgument(int* value)
+    {
+    double number;
+    if (!this->ReadNumber(this->NextTypeTag('i'), &number)) return false;
+    *value = static_cast<int>(number);
+    return true;
+    }
+
+  bool ReadDoubleArgument(double* value)
+    {
+    return this->ReadNumber(this->NextTypeTag('d'), value);
+    }
+
+private:
+  const char* Position;
+  const char* End;
+  const char* TypeTags;
+
+  char NextTypeTag(char assumed)
+    {
+    if (!this->TypeTags) return assumed;
+    if (*this->TypeTags == '\0') return '\0';
+    return *this->TypeTags++;
+    }
+
+  bool ReadNumber(char tag, double* value)
+    {
+    unsigned char bytes[8];
+    switch (tag)
+      {
+      case 'i':
+        {
+        int i;
+        if (!this->ReadBigEndian(bytes, 4)) return false;
+        memcpy(&i, bytes, 4);
+        *value = i;
+        return true;
+        }
+      case 'f':
+        {
+        float f;
+        if (!this->ReadBigEndian(bytes, 4)) return false;
+        memcpy(&f, bytes, 4);
+        *value = f;
+        return true;
+        }
+      case 'd':
+        {
+        if (!this->ReadBigEndian(bytes, 8)) return false;
+        memcpy(value, bytes, 8);
+        return true;
+        }
+      }
+
+    // Unsupported or missing argument
+    return false;
+    }
+
+  bool ReadBigEndian(unsigned char* bytes, int numBytes)
+    {
+    if (numBytes > this->GetRemaining()) return false;
+
+#ifdef VTK_WORDS_BIGENDIAN
+    memcpy(bytes, this->Position, numBytes);
+#else
+    for (int i = 0; i < numBytes; i++) 
+      {
+      bytes[i] = static_cast<unsigned char>(this->Position[numBytes - i - 1]);
+      }
+#endif
+
+    this->Position += numBytes;
+    return true;
+    }
+};
+
 class vtkRenciMultiTouchInternals
 {
 public:
-  vtkstd::string GestureName;
-  vtkstd::vector<TouchPoint> TouchPoints;
+  vtkRenciMultiTouchInternals() 
+    { 
+    this->Batch = NULL;
+    this->NumberOfBatchGestures = 0;
+
+    this->NoGesture.GestureType = -1;
+    this->NoGesture.NumberOfTouchPoints = 0;
+    this->NoGesture.ArrivalTime = 0.0;
+    this->Gesture = this->NoGesture;
+
+    this->Queue.NumberOfGestures = 0;
+    this->Queue.FirstNumber = 0;
+    this->Queue.Sequence = 0;
+    this->SetDelivery(&this->Queue, 0);
+
+    int numBuiltIn = sizeof(BuiltInGestures) / sizeof(BuiltInGestures[0]);
+    for (int i = 0; i < numBuiltIn; i++)
+      {
+      this->AddGestureType(BuiltInGestures[i].Name, BuiltInGestures[i].EventId);
+      }
+    this->ReleaseGestureType = this->FindGestureType("release", 7);
+    }
+
+  // Returns the index of the gesture name in GestureNames, or -1
+  int FindGestureType(const char* name, int length)
+    {
+    unsigned int mask = static_cast<unsigned int>(this->GestureTable.size()) - 1;
+    for (unsigned int i = HashGestureName(name, length) & mask; ; i = (i + 1) & mask)
+      {
+      int type = this->GestureTable[i];
+      if (type == -1) return -1;
+
+      const vtkstd::string& typeName = this->GestureNames[type];
+      if (static_cast<int>(typeName.size()) == length && 
+          memcmp(typeName.data(), name, length) == 0)
+        {
+        return type;
+        }
+      }
+    }
+
+  // Add a gesture name, or change the event of an existing one
+  void AddGestureType(const char* name, unsigned long eventId)
+    {
+    int length = static_cast<int>(strlen(name));
+    int type = this->GestureTable.empty() ? -1 : this->FindGestureType(name, length);
+    if (type != -1)
+      {
+      this->GestureEventIds[type] = eventId;
+      return;
+      }
+
+    this->GestureNames.push_back(name);
+    this->GestureEventIds.push_back(eventId);
+
+    // Keep the table at most half full, so probe sequences stay short
+    if (this->GestureTable.size() < 2 * this->GestureNames.size())
+      {
+      unsigned int size = 64;
+      while (size < 2 * this->GestureNames.size()) size *= 2;
+      this->GestureTable.assign(size, -1);
+
+      for (unsigned int i = 0; i < this->GestureNames.size(); i++)
+        {
+        this->InsertGestureType(i);
+        }
+      }
+    else
+      {
+      this->InsertGestureType(static_cast<int>(this->GestureNames.size()) - 1);
+      }
+    }
+
+  void InsertGestureType(int type)
+    {
+    const vtkstd::string& name = this->GestureNames[type];
+    unsigned int mask = static_cast<unsigned int>(this->GestureTable.size()) - 1;
+    unsigned int i = HashGestureName(name.data(), static_cast<int>(name.size())) & mask;
+    while (this->GestureTable[i] != -1) i = (i + 1) & mask;
+    this->GestureTable[i] = type;
+    }
+
+  // Gesture names and their events, indexed by gesture type
+  vtkstd::vector<vtkstd::string> GestureNames;
+  vtkstd::vector<unsigned long> GestureEventIds;
+
+  // Open addressing hash table from names to gesture types
+  vtkstd::vector<int> GestureTable;
+
+  int ReleaseGestureType;
+
+  // Allocate the datagram pool.  Called once the socket is created, so
+  // devices that are never initialized do not pay for it.
+  void AllocateDatagrams()
+    {
+    if (!this->Datagrams.empty()) return;
+
+    this->Datagrams.resize(DatagramPoolSize * MaximumDatagramSize);
+
+#ifdef VTK_RENCI_MULTI_TOUCH_USE_RECVMMSG
+    memset(this->Messages, 0, sizeof(this->Messages));
+    for (int i = 0; i < DatagramPoolSize; i++)
+      {
+      this->Vectors[i].iov_base = &this->Datagrams[i * MaximumDatagramSize];
+      this->Vectors[i].iov_len = MaximumDatagramSize;
+      this->Messages[i].msg_hdr.msg_iov = &this->Vectors[i];
+      this->Messages[i].msg_hdr.msg_iovlen = 1;
+      }
+#endif
+    }
+
+  // Deliver the gestures in queue from first on with the next event, and 
+  // make the last one current
+  void SetDelivery(const GestureQueue* queue, int first)
+    {
+    this->DeliveryQueue = queue;
+    this->FirstDelivery = first;
+
+    int num = queue->NumberOfGestures;
+    this->CurrentGesture = num > 0 ? &queue->Gestures[num - 1] : &this->NoGesture;
+    }
+
+  // Written by ParseBuffer()
+  GestureInformation Gesture;
+
+  // Current before any gesture is received
+  GestureInformation NoGesture;
+
+  // The gestures received by the last Update()
+  GestureQueue Queue;
+
+  // Preallocated pool the socket is drained into, MaximumDatagramSize 
+  // bytes per datagram
+  vtkstd::vector<char> Datagrams;
+  int DatagramLengths[DatagramPoolSize];
+#ifdef VTK_RENCI_MULTI_TOUCH_USE_RECVMMSG
+  struct mmsghdr Messages[DatagramPoolSize];
+  struct iovec Vectors[DatagramPoolSize];
+#endif
+
+  // Hands the gestures to the render thread when polling in a separate 
+  // thread
+  vtkInteractionDeviceTripleBuffer<GestureQueue> PublishedQueue;
+
+  // Polling thread.  Every gesture received since the render thread last 
+  // took the published queue.
+  GestureQueue PendingQueue;
+
+  // Render thread.  The sequence number of the last queue taken, read by 
+  // the polling thread, and the number, merged datagrams and summed 
+  // directions of the last gesture delivered.
+  volatile long ConsumedSequence;
+  long DeliveredNumber;
+  int DeliveredMerged;
+  double DeliveredDirections[VTK_RENCI_MULTI_TOUCH_MAX_TOUCH_POINTS][2];
+
+  // The gestures for InvokeInteractionEvent() to deliver.  Either Queue or
+  // the front buffer of PublishedQueue.
+  const GestureQueue* DeliveryQueue;
+  int FirstDelivery;
+
+  // Read by the get methods.  Points to a gesture in DeliveryQueue, or 
+  // NoGesture.
+  const GestureInformation* CurrentGesture;
+
+  // Every gesture since the last event, in batch mode.  Gestures have a
+  // fixed size, so nothing is allocated after the capacity is set.
+  vtkInteractionDeviceReportBuffer<GestureInformation> BatchGestures;
+
+  // The batch being delivered by InvokeInteractionEvent()
+  const GestureInformation* Batch;
+  int NumberOfBatchGestures;
 };
 
 vtkCxxRevisionMacro(vtkRenciMultiTouch, "$Revision: 1.0 $");
@@ -37,14 +544,15 @@ vtkRenciMultiTouch::vtkRenciMultiTouch()
 
   this->HostName = NULL;
   this->Port = -1;
-  this->SocketDescriptor = 0;
+  this->ReceiveBufferSize = 0;
+  this->SocketDescriptor = -1;
 }
 
 //----------------------------------------------------------------------------
 vtkRenciMultiTouch::~vtkRenciMultiTouch() 
 {
   this->SetHostName(NULL);
-  closesocket(this->SocketDescriptor);
+  this->CloseSocket();
 
   delete this->Internals;
 }
@@ -66,8 +574,6 @@ int vtkRenciMultiTouch::Initialize()
     vtkErrorMacro(<<"WSAStartup failed.");
     return 0;
     }
-#else
-  vtkErrorMacro(<<"Multi-touch currently only implemented on 32-bit Windows");
 #endif
 
   // Check that we have a server to connect to
@@ -83,6 +589,7 @@ int vtkRenciMultiTouch::Initialize()
     } 
 
   // Try to create the socket
+  this->CloseSocket();
   if (this->CreateSocket() != 0)
     {
     vtkErrorMacro(<<"Could not create socket!");
@@ -95,215 +602,462 @@ int vtkRenciMultiTouch::Initialize()
 //----------------------------------------------------------------------------
 void vtkRenciMultiTouch::Update() 
 {
-  this->ClearGesture();
+  this->Internals->Queue.Clear();
+
+  // Drain the socket, so gestures do not queue up in the kernel when they
+  // arrive faster than Update() is called
+  int numDatagrams;
+  while ((numDatagrams = this->ReceiveDatagrams()) > 0)
+    {
+    double arrivalTime = vtkTimerLog::GetUniversalTime();
+
+    for (int i = 0; i < numDatagrams; i++)
+      {
+      int numBytes = this->Internals->DatagramLengths[i];
+      if (numBytes <= 0) continue;
 
-  // Read from the socket
-  const int bufferSize = 16384;   // Magic number, taken from OSC MAX_UDP_PACKET_SIZE
-  char buffer[bufferSize];
-  memset(buffer, '\0', bufferSize);
+      // Tokenize
+      if (!this->ParseBuffer(&this->Internals->Datagrams[i * MaximumDatagramSize], numBytes))
+        {
+        continue;
+        }
+      this->Internals->Gesture.ArrivalTime = arrivalTime;
 
-  int numBytes = this->Receive(buffer, bufferSize);
+      // In batch mode also keep every gesture unmerged.  The queue then 
+      // only tells the render thread there is a new batch.
+      if (this->BatchMode)
+        {
+        this->Internals->BatchGestures.Push(this->Internals->Gesture);
+        }
+      this->Internals->Queue.Add(this->Internals->Gesture, 1);
+      }
 
-  if (numBytes <= 0 || numBytes > bufferSize)
+    // A partly filled pool means the socket is empty
+    if (numDatagrams < DatagramPoolSize) break;
+    }
+
+  // The polling thread publishes the queue instead
+  if (!this->Threaded)
     {
+    this->Internals->SetDelivery(&this->Internals->Queue, 0);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkRenciMultiTouch::RegisterGesture(const char* name, unsigned long eventId) 
+{
+  if (name == NULL)
+    {
+    vtkErrorMacro(<<"Gesture name is NULL.");
     return;
     }
 
-  // Tokenize
-  this->ParseBuffer(buffer, numBytes);
+  this->Internals->AddGestureType(name, eventId);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkRenciMultiTouch::GetGestureEventId(const char* name) 
+{
+  if (name == NULL) return 0;
+
+  int type = this->Internals->FindGestureType(name, static_cast<int>(strlen(name)));
+
+  return type == -1 ? 0 : this->Internals->GestureEventIds[type];
 }
 
 //----------------------------------------------------------------------------
 void vtkRenciMultiTouch::InvokeInteractionEvent() 
 {
-  if (this->Internals->GestureName == "") return;
+  this->ReportTime = 0.0;
+  this->ArrivalTime = 0.0;
 
-  if (this->Internals->GestureName == "one_touch")
-    {
-    this->InvokeEvent(vtkRenciMultiTouch::OneTouchEvent,NULL);
-    }
-  else if (this->Internals->GestureName == "one_drag")
-    {
-    this->InvokeEvent(vtkRenciMultiTouch::OneDragEvent,NULL);
-    }
-  else if (this->Internals->GestureName == "two_touch")
-    {
-    this->InvokeEvent(vtkRenciMultiTouch::TwoTouchEvent,NULL);
-    }
-  else if (this->Internals->GestureName == "two_drag")
-    {
-    this->InvokeEvent(vtkRenciMultiTouch::TwoDragEvent,NULL);
-    }
-  else if (this->Internals->GestureName == "three_touch")
-    {
-    this->InvokeEvent(vtkRenciMultiTouch::ThreeTouchEvent,NULL);
-    }
-  else if (this->Internals->GestureName == "three_drag")
-    {
-    this->InvokeEvent(vtkRenciMultiTouch::ThreeDragEvent,NULL);
-    }
-  else if (this->Internals->GestureName == "four_touch")
-    {
-    this->InvokeEvent(vtkRenciMultiTouch::FourTouchEvent,NULL);
-    }
-  else if (this->Internals->GestureName == "four_drag")
+  if (this->BatchMode)
     {
-    this->InvokeEvent(vtkRenciMultiTouch::FourDragEvent,NULL);
-    }
-  else if (this->Internals->GestureName == "five_touch")
-    {
-    this->InvokeEvent(vtkRenciMultiTouch::FiveTouchEvent,NULL);
-    }
-  else if (this->Internals->GestureName == "five_drag")
-    {
-    this->InvokeEvent(vtkRenciMultiTouch::FiveDragEvent,NULL);
-    }
-  else if (this->Internals->GestureName == "six_touch")
-    {
-    this->InvokeEvent(vtkRenciMultiTouch::SixTouchEvent,NULL);
-    }
-  else if (this->Internals->GestureName == "six_drag")
-    {
-    this->InvokeEvent(vtkRenciMultiTouch::SixDragEvent,NULL);
+    int numGestures = this->Internals->BatchGestures.Drain();
+    if (numGestures == 0) return;
+
+    this->ReportTime = this->ArrivalTime = this->Internals->BatchGestures.GetBatch()[0].ArrivalTime;
+
+    // Give observers the whole batch first
+    const GestureInformation* current = this->Internals->CurrentGesture;
+    this->Internals->Batch = this->Internals->BatchGestures.GetBatch();
+    this->Internals->NumberOfBatchGestures = numGestures;
+
+    this->InvokeEvent(vtkRenciMultiTouch::GestureBatchEvent,NULL);
+
+    // Then replay each gesture, so styles see every movement
+    for (int i = 0; i < numGestures; i++)
+      {
+      this->Internals->CurrentGesture = &this->Internals->Batch[i];
+
+      unsigned long eventId = this->Internals->GestureEventIds[this->Internals->CurrentGesture->GestureType];
+      if (eventId != 0) this->InvokeEvent(eventId,NULL);
+      }
+
+    this->Internals->CurrentGesture = current;
+    this->Internals->NumberOfBatchGestures = 0;
+    this->Internals->FirstDelivery = this->Internals->DeliveryQueue->NumberOfGestures;
+
+    return;
     }
-  else if (this->Internals->GestureName == "zoom")
+
+  // Invoke the event for each gesture since the last call in order, so 
+  // gestures between events are not lost
+  const GestureQueue* queue = this->Internals->DeliveryQueue;
+  int first = this->Internals->FirstDelivery;
+  this->Internals->FirstDelivery = queue->NumberOfGestures;
+  if (first >= queue->NumberOfGestures) return;
+
+  this->ReportTime = this->ArrivalTime = queue->Gestures[first].ArrivalTime;
+
+  const GestureInformation* current = this->Internals->CurrentGesture;
+  for (int i = first; i < queue->NumberOfGestures; i++)
     {
-    this->InvokeEvent(vtkRenciMultiTouch::ZoomEvent,NULL);
+    this->Internals->CurrentGesture = &queue->Gestures[i];
+
+    unsigned long eventId = this->Internals->GestureEventIds[queue->Gestures[i].GestureType];
+    if (eventId != 0) this->InvokeEvent(eventId,NULL);
     }
-  else if (this->Internals->GestureName == "translate_x")
+  this->Internals->CurrentGesture = current;
+}
+
+//----------------------------------------------------------------------------
+void vtkRenciMultiTouch::SetThreaded(int threaded) 
+{
+  vtkRenciMultiTouchInternals* internals = this->Internals;
+
+  if (threaded)
     {
-    this->InvokeEvent(vtkRenciMultiTouch::TranslateXEvent,NULL);
+    internals->PendingQueue.NumberOfGestures = 0;
+    internals->PendingQueue.FirstNumber = 0;
+    internals->PendingQueue.Sequence = 0;
+    internals->PublishedQueue.Reset(internals->PendingQueue);
+
+    internals->ConsumedSequence = 0;
+    internals->DeliveredNumber = -1;
+    internals->DeliveredMerged = 0;
+
+    internals->SetDelivery(&internals->PublishedQueue.GetFrontBuffer(), 0);
     }
-  else if (this->Internals->GestureName == "translate_y")
+  else
     {
-    this->InvokeEvent(vtkRenciMultiTouch::TranslateYEvent,NULL);
+    internals->Queue.Clear();
+    internals->SetDelivery(&internals->Queue, 0);
     }
-  else if (this->Internals->GestureName == "translate_z")
+
+  this->Superclass::SetThreaded(threaded);
+}
+
+//----------------------------------------------------------------------------
+void vtkRenciMultiTouch::PublishState() 
+{
+  // Only publish when a gesture was received, so the render thread does 
+  // not see polling iterations without data
+  vtkRenciMultiTouchInternals* internals = this->Internals;
+  const GestureQueue& queue = internals->Queue;
+  if (queue.NumberOfGestures == 0) return;
+
+  // Update() starts a new queue every iteration, so add it to the gestures
+  // the render thread has not taken yet, or gestures are lost when polling
+  // is faster than rendering.  Start over once the last publication is 
+  // taken.
+  GestureQueue& pending = internals->PendingQueue;
+  if (vtkInteractionDeviceAtomicLoad(&internals->ConsumedSequence) == pending.Sequence)
     {
-    this->InvokeEvent(vtkRenciMultiTouch::TranslateZEvent,NULL);
+    pending.Clear();
     }
-  else if (this->Internals->GestureName == "about_X_axis")
+  for (int i = 0; i < queue.NumberOfGestures; i++)
     {
-    this->InvokeEvent(vtkRenciMultiTouch::RotateYEvent,NULL);
+    pending.Add(queue.Gestures[i], queue.NumberOfMerged[i]);
     }
-  else if (this->Internals->GestureName == "about_Y_axis")
+  pending.Sequence++;
+
+  internals->PublishedQueue.GetBackBuffer().Copy(pending);
+  internals->PublishedQueue.Publish();
+}
+
+//----------------------------------------------------------------------------
+int vtkRenciMultiTouch::ConsumeState() 
+{
+  vtkRenciMultiTouchInternals* internals = this->Internals;
+
+  if (!internals->PublishedQueue.Consume()) return 0;
+
+  // Let the polling thread start a new queue
+  GestureQueue& queue = internals->PublishedQueue.GetFrontBuffer();
+  vtkInteractionDeviceAtomicExchange(&internals->ConsumedSequence, queue.Sequence);
+
+  // The polling thread may have added to the queue before seeing the last
+  // one was taken, so skip the gestures already delivered.  Gestures keep 
+  // their number while merged into, so if the last one delivered has more
+  // datagrams now, only deliver the movement since.
+  int num = queue.NumberOfGestures;
+  int first = 0;
+  while (first < num && queue.FirstNumber + first < internals->DeliveredNumber) first++;
+
+  int last = num - 1;
+  GestureInformation& lastGesture = queue.Gestures[last];
+  double directions[VTK_RENCI_MULTI_TOUCH_MAX_TOUCH_POINTS][2];
+  for (int i = 0; i < lastGesture.NumberOfTouchPoints; i++)
     {
-    this->InvokeEvent(vtkRenciMultiTouch::RotateYEvent,NULL);
+    directions[i][0] = lastGesture.TouchPoints[i].Direction[0];
+    directions[i][1] = lastGesture.TouchPoints[i].Direction[1];
     }
-  else if (this->Internals->GestureName == "about_Z_axis")
+
+  if (first < num && queue.FirstNumber + first == internals->DeliveredNumber)
     {
-    this->InvokeEvent(vtkRenciMultiTouch::RotateZEvent,NULL);
+    if (queue.NumberOfMerged[first] == internals->DeliveredMerged)
+      {
+      first++;
+      }
+    else
+      {
+      GestureInformation& gesture = queue.Gestures[first];
+      for (int i = 0; i < gesture.NumberOfTouchPoints; i++)
+        {
+        gesture.TouchPoints[i].Direction[0] -= internals->DeliveredDirections[i][0];
+        gesture.TouchPoints[i].Direction[1] -= internals->DeliveredDirections[i][1];
+        }
+      }
     }
-  else if (this->Internals->GestureName == "release")
+
+  internals->DeliveredNumber = queue.FirstNumber + last;
+  internals->DeliveredMerged = queue.NumberOfMerged[last];
+  for (int i = 0; i < lastGesture.NumberOfTouchPoints; i++)
     {
-    this->InvokeEvent(vtkRenciMultiTouch::ReleaseEvent,NULL);
+    internals->DeliveredDirections[i][0] = directions[i][0];
+    internals->DeliveredDirections[i][1] = directions[i][1];
     }
+
+  internals->SetDelivery(&queue, first);
+
+  return first < num;
+}
+
+//----------------------------------------------------------------------------
+void vtkRenciMultiTouch::SetBatchMode(int batchMode) 
+{
+  this->Internals->BatchGestures.SetCapacity(batchMode ? this->BatchCapacity : 0);
+
+  this->Superclass::SetBatchMode(batchMode);
+}
+
+//----------------------------------------------------------------------------  
+int vtkRenciMultiTouch::GetNumberOfBatchGestures()
+{
+  return this->Internals->NumberOfBatchGestures;
+}
+
+//----------------------------------------------------------------------------  
+const char* vtkRenciMultiTouch::GetBatchGestureName(int gesture)
+{
+  return this->Internals->GestureNames[this->Internals->Batch[gesture].GestureType].c_str();
+}
+
+//----------------------------------------------------------------------------  
+int vtkRenciMultiTouch::GetBatchNumberOfTouchPoints(int gesture)
+{
+  return this->Internals->Batch[gesture].NumberOfTouchPoints;
+}
+
+//----------------------------------------------------------------------------  
+const TouchPoint& vtkRenciMultiTouch::GetBatchTouchPoint(int gesture, int which)
+{
+  return this->Internals->Batch[gesture].TouchPoints[which];
+}
+
+//----------------------------------------------------------------------------  
+const TouchPoint* vtkRenciMultiTouch::GetBatchTouchPoints(int gesture)
+{
+  return this->Internals->Batch[gesture].TouchPoints;
 }
 
 //----------------------------------------------------------------------------  
 int vtkRenciMultiTouch::GetNumberOfTouchPoints()
 {
-  return this->Internals->TouchPoints.size();
+  return this->Internals->CurrentGesture->NumberOfTouchPoints;
 }
 
 //----------------------------------------------------------------------------  
 const TouchPoint& vtkRenciMultiTouch::GetTouchPoint(int which)
 {
-  return this->Internals->TouchPoints[which];
+  return this->Internals->CurrentGesture->TouchPoints[which];
+}
+
+//----------------------------------------------------------------------------  
+const TouchPoint* vtkRenciMultiTouch::GetTouchPoints()
+{
+  return this->Internals->CurrentGesture->TouchPoints;
 }
 
 //----------------------------------------------------------------------------
-void vtkRenciMultiTouch::ParseBuffer(char* buffer, int numBytes)
+int vtkRenciMultiTouch::ParseBuffer(const char* buffer, int numBytes)
 {
-  // Create a vtkStdString to make parsing certain things easier
-  vtkstd::string s(buffer, numBytes);
+  this->ClearGesture();
+
+  vtkRenciMultiTouchOSCReader reader(buffer, numBytes);
 
-  // Flag for the end of osc header junk
-  const vtkstd::string start_flag = "set";
+  const char* address;
+  int addressLength;
+  if (!reader.ReadString(&address, &addressLength)) return 0;
 
-  // Find our start position  
-  unsigned int si = 0;
-  while (si < s.size() - start_flag.size() && (s.substr(si, start_flag.size())).compare(start_flag) != 0)
+  if (addressLength == 7 && memcmp(address, "#bundle", 7) == 0)
     {
-    si++;
-    }
+    // Skip the time tag, then use the first element holding a gesture
+    if (!reader.Skip(8)) return 0;
 
-  // Skip past start_flag
-  si += (int)start_flag.size() + 1;
+    while (!reader.AtEnd())
+      {
+      int size;
+      if (!reader.ReadInt(&size) || size < 0 || size > reader.GetRemaining()) return 0;
 
-  vtkstd::string str = s.substr(si);
+      if (this->ParseBuffer(reader.GetPosition(), size)) return 1;
 
-  // Find the gesture type
-  this->Internals->GestureName = str.substr(0, str.find_first_of('\0'));
+      reader.Skip(size);
+      }
 
-  if (this->Internals->GestureName == "release")
+    return 0;
+    }
+
+  // Type tags are optional in OSC 1.0.  Without them the arguments are
+  // assumed to be laid out as the gesture server sends them.
+  if (!reader.AtEnd() && *reader.GetPosition() == ',')
     {
-    // No more info.  Return.
-    return;
+    const char* tags;
+    int numTags;
+    if (!reader.ReadString(&tags, &numTags)) return 0;
+    reader.SetTypeTags(tags + 1);
+    }
+
+  // The gesture follows a "set" string
+  const char* name;
+  int nameLength;
+  do
+    {
+    if (!reader.ReadStringArgument(&name, &nameLength)) return 0;
     }
+  while (nameLength != 3 || memcmp(name, "set", 3) != 0);
 
-  // Skip to next 4 byte chunk after the gesture name (including '\0')
-  int chunkDist = 4 - ((int)this->Internals->GestureName.size() + 1) % 4;
-  if (chunkDist == 4) chunkDist = 0;
-  char* bufPtr = buffer + si + this->Internals->GestureName.size() + 1 + chunkDist;
+  if (!reader.ReadStringArgument(&name, &nameLength)) return 0;
 
-  // Get the number of touches
-  int numTouches = this->ReadInt(&bufPtr);
+  // Ignore gestures that are not registered
+  GestureInformation& gesture = this->Internals->Gesture;
+  gesture.GestureType = this->Internals->FindGestureType(name, nameLength);
+  if (gesture.GestureType == -1) return 0;
+
+  if (gesture.GestureType == this->Internals->ReleaseGestureType)
+    {
+    // No more info
+    return 1;
+    }
+
+  int numTouches;
+  if (!reader.ReadIntArgument(&numTouches) || numTouches < 0)
+    {
+    this->ClearGesture();
+    return 0;
+    }
 
   for (int i = 0; i < numTouches; i++) 
     {
     TouchPoint tp;
 
     // Fill in the touch point
-    tp.Id = this->ReadInt(&bufPtr);
-    tp.Location[0] = this->ReadDouble(&bufPtr);
-    tp.Location[1] = this->ReadDouble(&bufPtr);
-    tp.Direction[0] = this->ReadDouble(&bufPtr);
-    tp.Direction[1] = this->ReadDouble(&bufPtr);
-    tp.MoveLocation = this->ReadInt(&bufPtr);
+    if (!reader.ReadIntArgument(&tp.Id) ||
+        !reader.ReadDoubleArgument(&tp.Location[0]) ||
+        !reader.ReadDoubleArgument(&tp.Location[1]) ||
+        !reader.ReadDoubleArgument(&tp.Direction[0]) ||
+        !reader.ReadDoubleArgument(&tp.Direction[1]) ||
+        !reader.ReadIntArgument(&tp.MoveLocation))
+      {
+      this->ClearGesture();
+      return 0;
+      }
 
-    this->Internals->TouchPoints.push_back(tp);
+    if (gesture.NumberOfTouchPoints < VTK_RENCI_MULTI_TOUCH_MAX_TOUCH_POINTS)
+      {
+      gesture.TouchPoints[gesture.NumberOfTouchPoints++] = tp;
+      }
     }
+
+  return 1;
 }
 
 //----------------------------------------------------------------------------
 void vtkRenciMultiTouch::ClearGesture() 
 {
-  this->Internals->GestureName = "";
-  this->Internals->TouchPoints.clear();
+  this->Internals->Gesture.GestureType = -1;
+  this->Internals->Gesture.NumberOfTouchPoints = 0;
+  this->Internals->Gesture.ArrivalTime = 0.0;
 }
 
 //----------------------------------------------------------------------------
 int vtkRenciMultiTouch::CreateSocket()
 {
   // Create a UDP socket
-  this->SocketDescriptor = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-  if (this->SocketDescriptor == INVALID_SOCKET)
+  int sd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (sd == INVALID_SOCKET)
     {
     vtkErrorMacro(<<"Could not create socket!");
     return -1;
     }
+  this->SocketDescriptor = sd;
+
+  this->Internals->AllocateDatagrams();
 
   // Make non-blocking
+#ifdef WIN32
   u_long blocking = 1;
   if (ioctlsocket(this->SocketDescriptor, FIONBIO, &blocking) == SOCKET_ERROR)
+#else
+  int flags = fcntl(this->SocketDescriptor, F_GETFL, 0);
+  if (flags == -1 || fcntl(this->SocketDescriptor, F_SETFL, flags | O_NONBLOCK) == -1)
+#endif
     {
     vtkErrorMacro(<<"Could not set non-blocking mode!");
-    closesocket(this->SocketDescriptor);
+    this->CloseSocket();
     return -1;
     }
 
+  // Make room for bursts of datagrams.  Must be done before binding.
+  if (this->ReceiveBufferSize > 0)
+    {
+    int size = this->ReceiveBufferSize;
+    if (setsockopt(this->SocketDescriptor, SOL_SOCKET, SO_RCVBUF, 
+                   reinterpret_cast<char*>(&size), sizeof(size)) == SOCKET_ERROR)
+      {
+      vtkWarningMacro(<<"Could not set receive buffer size to " << this->ReceiveBufferSize << " bytes.");
+      }
+    else
+      {
+#ifdef WIN32
+      int length = sizeof(size);
+#else
+      socklen_t length = sizeof(size);
+#endif
+      if (getsockopt(this->SocketDescriptor, SOL_SOCKET, SO_RCVBUF, 
+                     reinterpret_cast<char*>(&size), &length) != SOCKET_ERROR && 
+          size < this->ReceiveBufferSize)
+        {
+        vtkWarningMacro(<<"Requested a receive buffer of " << this->ReceiveBufferSize 
+                        << " bytes, but got " << size << " bytes.");
+        }
+      }
+    }
+
   // Set up the server information
-  struct sockaddr_in server = {0};
+  struct sockaddr_in server;
+  memset(&server, 0, sizeof(server));
   server.sin_family = AF_INET;
   server.sin_port = htons(this->Port);
   server.sin_addr.s_addr = INADDR_ANY;
 
   // Bind the address to the socket
-  if (bind(this->SocketDescriptor, reinterpret_cast<struct sockaddr*>(&server), sizeof(sockaddr)) == SOCKET_ERROR)
+  if (bind(this->SocketDescriptor, reinterpret_cast<struct sockaddr*>(&server), sizeof(server)) == SOCKET_ERROR)
     {
     vtkErrorMacro(<<"Could not bind name to socket!");
-    closesocket(this->SocketDescriptor);
+    this->CloseSocket();
     return -1;
     }
 
@@ -311,46 +1065,72 @@ int vtkRenciMultiTouch::CreateSocket()
 }
 
 //----------------------------------------------------------------------------
-int vtkRenciMultiTouch::Receive(void* data, int length)
+void vtkRenciMultiTouch::CloseSocket()
 {
-  return recvfrom(this->SocketDescriptor, (char*)data, length, 0, 0, 0);
+  if (this->SocketDescriptor == -1) return;
+
+  closesocket(this->SocketDescriptor);
+  this->SocketDescriptor = -1;
 }
 
 //----------------------------------------------------------------------------
-int vtkRenciMultiTouch::ReadInt(char** buffer)
+int vtkRenciMultiTouch::Receive(void* data, int length)
 {
-  char intBuffer[4];
-  memcpy(intBuffer, *buffer, 4);
+  if (this->SocketDescriptor == -1) return -1;
 
-  *buffer += 4;
+#ifdef WIN32
+  return recvfrom(this->SocketDescriptor, (char*)data, length, 0, 0, 0);
+#else
+  // Retry if interrupted by a signal.  Returns -1 with EAGAIN when no 
+  // datagram is waiting.
+  int numBytes;
+  do
+    {
+    numBytes = recvfrom(this->SocketDescriptor, data, length, 0, 0, 0);
+    }
+  while (numBytes == -1 && errno == EINTR);
 
-  return ntohl(*((int*)intBuffer));
+  return numBytes;
+#endif
 }
 
 //----------------------------------------------------------------------------
-double vtkRenciMultiTouch::ReadDouble(char** buffer)
+int vtkRenciMultiTouch::ReceiveDatagrams()
 {
-  char doubleBuffer[8];
-  memcpy(doubleBuffer, *buffer, 8);
+  if (this->SocketDescriptor == -1 || this->Internals->Datagrams.empty()) return 0;
 
-  *buffer += 8;
-
-  return this->Ntohd(*((double*)doubleBuffer));
-}
+#ifdef VTK_RENCI_MULTI_TOUCH_USE_RECVMMSG
+  // The socket is non-blocking, so this returns what is waiting
+  int numDatagrams;
+  do
+    {
+    numDatagrams = recvmmsg(this->SocketDescriptor, this->Internals->Messages, 
+                            DatagramPoolSize, 0, NULL);
+    }
+  while (numDatagrams == -1 && errno == EINTR);
 
-//----------------------------------------------------------------------------
-double vtkRenciMultiTouch::Ntohd(double d) 
-{
-  double swapped;
-  char* chSwapped = (char*)&swapped;
-  char* chD = (char*)&d;
+  for (int i = 0; i < numDatagrams; i++)
+    {
+    // Skip datagrams that did not fit
+    this->Internals->DatagramLengths[i] = 
+      this->Internals->Messages[i].msg_hdr.msg_flags & MSG_TRUNC ? 
+      0 : static_cast<int>(this->Internals->Messages[i].msg_len);
+    }
 
-  for (int i = 0; i < sizeof(double); i++) 
+  return numDatagrams > 0 ? numDatagrams : 0;
+#else
+  int numDatagrams = 0;
+  while (numDatagrams < DatagramPoolSize)
     {
-    chSwapped[i] = chD[sizeof(double) - i - 1];
+    int numBytes = this->Receive(&this->Internals->Datagrams[numDatagrams * MaximumDatagramSize], 
+                                 MaximumDatagramSize);
+    if (numBytes < 0) break;
+
+    this->Internals->DatagramLengths[numDatagrams++] = numBytes;
     }
 
-  return swapped;
+  return numDatagrams;
+#endif
 }
 
 //----------------------------------------------------------------------------
@@ -358,20 +1138,24 @@ void vtkRenciMultiTouch::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
 
-  os << indent << "HostName: " << this->HostName << "\n";
+  os << indent << "HostName: " << (this->HostName ? this->HostName : "(none)") << "\n";
   os << indent << "Port: " << this->Port << "\n";
+  os << indent << "ReceiveBufferSize: " << this->ReceiveBufferSize << "\n";
   os << indent << "SocketDescriptor: " << this->SocketDescriptor << "\n";
-  os << indent << "GestureName: " << this->Internals->GestureName << "\n";
+  os << indent << "NumberOfGestureTypes: " << this->Internals->GestureNames.size() << "\n";
+  os << indent << "GestureName: " 
+     << (this->Internals->Gesture.GestureType == -1 ? "" : this->Internals->GestureNames[this->Internals->Gesture.GestureType].c_str()) 
+     << "\n";
   os << indent << "TouchPoints:\n";
-  for (unsigned int i = 0; i < this->Internals->TouchPoints.size(); i++)
+  for (int i = 0; i < this->Internals->Gesture.NumberOfTouchPoints; i++)
     {
     os << indent << indent << "TouchPoint " << i << "\n";
-    os << indent << indent << indent << "Id: " << this->Internals->TouchPoints[i].Id << "\n";
-    os << indent << indent << indent << "Location: (" << this->Internals->TouchPoints[i].Location[0]
-       << ", " << this->Internals->TouchPoints[i].Location[1] << ")\n";
-    os << indent << indent << indent << "Direction: (" << this->Internals->TouchPoints[i].Direction[0]
-       << ", " << this->Internals->TouchPoints[i].Direction[1] << ")\n";    
-    os << indent << indent << indent << "MoveLocation " << this->Internals->TouchPoints[i].MoveLocation << "\n";    
+    os << indent << indent << indent << "Id: " << this->Internals->Gesture.TouchPoints[i].Id << "\n";
+    os << indent << indent << indent << "Location: (" << this->Internals->Gesture.TouchPoints[i].Location[0]
+       << ", " << this->Internals->Gesture.TouchPoints[i].Location[1] << ")\n";
+    os << indent << indent << indent << "Direction: (" << this->Internals->Gesture.TouchPoints[i].Direction[0]
+       << ", " << this->Internals->Gesture.TouchPoints[i].Direction[1] << ")\n";    
+    os << indent << indent << indent << "MoveLocation " << this->Internals->Gesture.TouchPoints[i].MoveLocation << "\n";    
     }
   os << "\n";
 }
\ No newline at end of file
@@ -17,7 +17,9 @@
 // .SECTION Description
 // vtkRenciMultiTouch interfaces with multi-touch devices developed at
 // the Renaissance Computing Institute 
-// (http://vis.renci.org/multitouch/).  
+// (http://vis.renci.org/multitouch/).  Gestures are received as UDP 
+// datagrams on a non-blocking socket, using Winsock on Windows and BSD 
+// sockets elsewhere.
 
 // .SECTION see also
 // vtkInteractionDeviceManager vtkDeviceInteractorStyle
@@ -45,6 +47,12 @@ struct TouchPoint
   int MoveLocation;
 };
 
+// Touch points kept per gesture.  Any more sent by the server are dropped.
+#define VTK_RENCI_MULTI_TOUCH_MAX_TOUCH_POINTS 32
+
+// Different gestures kept between events.  Any more drop the oldest.
+#define VTK_RENCI_MULTI_TOUCH_MAX_QUEUED_GESTURES 16
+
 // Holds vtkstd member variables, which must be hidden
 class vtkRenciMultiTouchInternals;
 
@@ -60,22 +68,86 @@ public:
   virtual int Initialize();
 
   // Description:
-  // Receive updates from the device
+  // Receive updates from the device.  Every datagram waiting on the socket
+  // is read, so the gesture acted on is never older than the last call.
+  // Gestures are queued in order, and consecutive datagrams of the same 
+  // gesture with the same touch points are merged into one by summing 
+  // their directions.  Up to VTK_RENCI_MULTI_TOUCH_MAX_QUEUED_GESTURES 
+  // different gestures are kept between events.
   virtual void Update();
 
   // Description:
-  // Invoke events for observers to listen for
+  // Invoke the event for each gesture queued since the last call, in 
+  // order.  The get methods return the gesture being delivered.
   virtual void InvokeInteractionEvent();
 
+  // Description:
+  // Hand the queued gestures to the render thread when updated from the 
+  // vtkDeviceInteractor polling thread.  Gestures keep being queued and 
+  // merged the same way as in Update() until the render thread takes them,
+  // so no gesture or drag movement is lost when polling is faster than 
+  // rendering.
+  virtual void SetThreaded(int threaded);
+  virtual void PublishState();
+  virtual int ConsumeState();
+
+  // Description:
+  // In batch mode, Update() keeps every gesture received instead of 
+  // merging them, and InvokeInteractionEvent() first invokes 
+  // GestureBatchEvent with all gestures received since the last call, then
+  // the usual event for each gesture in order.
+  virtual void SetBatchMode(int batchMode);
+
   // Description:
   // Set socket information.  Must be set before Initialize().
   vtkSetStringMacro(HostName);
   vtkSetMacro(Port,int);
 
   // Description:
-  // Get methods for gesture data
+  // Size in bytes to request for the socket's receive buffer, so bursts of
+  // datagrams from the gesture server are not dropped by the operating 
+  // system before Update() reads them.  The system may grant a different
+  // size, e.g. Linux doubles the request and caps it at 
+  // net.core.rmem_max.  0 keeps the system default.  Must be set before 
+  // Initialize().
+  vtkSetClampMacro(ReceiveBufferSize,int,0,VTK_INT_MAX);
+  vtkGetMacro(ReceiveBufferSize,int);
+
+  // Description:
+  // The socket descriptor, or -1 before Initialize().  The socket is 
+  // non-blocking, so it can be added to select(), poll() or epoll to wait
+  // for gestures, and Update() called when it is readable.
+  int GetFileDescriptor() { return this->SocketDescriptor; }
+
+  // Description:
+  // Map a gesture name sent by the server to the event invoked for it, 
+  // e.g. a new gesture to a vtkCommand::UserEvent beyond GestureBatchEvent.
+  // Built-in names such as "one_drag" can be remapped, and 0 ignores a 
+  // gesture.  Gestures with names that are not registered are dropped.  
+  // Do not call while the vtkDeviceInteractor polling thread is updating 
+  // the device.
+  void RegisterGesture(const char* name, unsigned long eventId);
+
+  // Description:
+  // Get the event invoked for a gesture name, or 0 if it is not registered
+  unsigned long GetGestureEventId(const char* name);
+
+  // Description:
+  // Get methods for gesture data.  GetTouchPoints() returns all 
+  // GetNumberOfTouchPoints() touch points, which are stored in place and 
+  // stay valid until the next gesture is handled.
   int GetNumberOfTouchPoints();
   const TouchPoint& GetTouchPoint(int which);
+  const TouchPoint* GetTouchPoints();
+
+  // Description:
+  // Get methods for the batch of gestures.  Only valid while observers of
+  // GestureBatchEvent are being called.
+  int GetNumberOfBatchGestures();
+  const char* GetBatchGestureName(int gesture);
+  int GetBatchNumberOfTouchPoints(int gesture);
+  const TouchPoint& GetBatchTouchPoint(int gesture, int which);
+  const TouchPoint* GetBatchTouchPoints(int gesture);
 
   // Enumeration for multi-touch events
   //BTX
@@ -99,7 +171,8 @@ public:
       RotateXEvent,
       RotateYEvent,
       RotateZEvent,
-      ReleaseEvent
+      ReleaseEvent,
+      GestureBatchEvent
   };
   //ETX
 
@@ -110,13 +183,16 @@ protected:
   // The socket being read
   char* HostName;
   int Port;
+  int ReceiveBufferSize;
   int SocketDescriptor;
 
   vtkRenciMultiTouchInternals* Internals;
 
   // Description:
-  // Parse the buffer
-  void ParseBuffer(char* buffer, int numBytes);
+  // Decode the gesture in an OSC message or bundle in place.  Every read is
+  // checked against numBytes.  Returns 0 and clears the gesture if the 
+  // datagram does not hold a complete gesture.
+  int ParseBuffer(const char* buffer, int numBytes);
 
   // Description:
   // Clear the current gesture
@@ -125,10 +201,13 @@ protected:
   // Description:
   // Socket code.  vtkSocket currently uses TCP, so leave this code in here for now.
   int CreateSocket();
+  void CloseSocket();
   int Receive(void* data, int length);
-  int ReadInt(char** buffer);
-  double ReadDouble(char** buffer);
-  double Ntohd(double d);
+
+  // Description:
+  // Read as many waiting datagrams as fit in the preallocated pool, with a
+  // single recvmmsg() call on Linux.  Returns the number read.
+  int ReceiveDatagrams();
 
 private:
   vtkRenciMultiTouch(const vtkRenciMultiTouch&);  // Not implemented.
@@ -17,11 +17,9 @@
 #include "vtkRenciMultiTouchStyleCamera.h"
 
 #include "vtkCamera.h"
-#include "vtkInteractorObserver.h"
+#include "vtkDeviceViewTransform.h"
 #include "vtkMath.h"
 #include "vtkObjectFactory.h"
-#include "vtkstd/string"
-#include "vtkstd/vector"
 
 vtkStandardNewMacro(vtkRenciMultiTouchStyleCamera);
 vtkCxxRevisionMacro(vtkRenciMultiTouchStyleCamera, "$Revision: 1.0 $");
@@ -29,6 +27,7 @@ vtkCxxRevisionMacro(vtkRenciMultiTouchStyleCamera, "$Revision: 1.0 $");
 //----------------------------------------------------------------------------
 vtkRenciMultiTouchStyleCamera::vtkRenciMultiTouchStyleCamera() 
 { 
+  this->RenderOnSceneModified = 1;
 }
 
 //----------------------------------------------------------------------------
@@ -83,28 +82,22 @@ void vtkRenciMultiTouchStyleCamera::OnEvent(vtkObject* caller, unsigned long eid
 //----------------------------------------------------------------------------
 void vtkRenciMultiTouchStyleCamera::OnOneDrag(vtkRenciMultiTouch* multiTouch)
 {
-  vtkCamera* camera = this->Renderer->GetActiveCamera();
-
   int numTouches = multiTouch->GetNumberOfTouchPoints();
   if (numTouches < 1) return;
 
-  vtkstd::vector<TouchPoint> touches;
-  touches.resize(numTouches);
-  for (int i = 0; i < numTouches; i++) 
-    {
-    touches[i] = multiTouch->GetTouchPoint(i);
-    }
+  // Read the touch points in place
+  const TouchPoint* touches = multiTouch->GetTouchPoints();
 
   // XXX: Magic number
   double rotateSensitivity = 500.0;
   double dx = touches[0].Direction[0] * rotateSensitivity;
   double dy = touches[0].Direction[1] * rotateSensitivity; 
 
-  camera->Azimuth(-dx);
-  camera->Elevation(dy);
-  camera->OrthogonalizeViewUp();
+  this->AzimuthCamera(-dx);
+  this->ElevationCamera(dy);
 
-  this->Renderer->ResetCameraClippingRange();
+  this->ResetCameraClippingRange();
+  this->SceneModified = 1;
   // Render() will be called in the interactor
 }
 
@@ -116,12 +109,8 @@ void vtkRenciMultiTouchStyleCamera::OnZoom(vtkRenciMultiTouch* multiTouch)
   int numTouches = multiTouch->GetNumberOfTouchPoints();
   if (numTouches < 2) return;
 
-  vtkstd::vector<TouchPoint> touches;
-  touches.resize(numTouches);
-  for (int i = 0; i < numTouches; i++) 
-    {
-    touches[i] = multiTouch->GetTouchPoint(i);
-    }
+  // Read the touch points in place
+  const TouchPoint* touches = multiTouch->GetTouchPoints();
 
   double zoomAmount = sqrt(touches[0].Direction[0] * touches[0].Direction[0] +
                            touches[0].Direction[1] * touches[0].Direction[1]);
@@ -152,14 +141,15 @@ void vtkRenciMultiTouchStyleCamera::OnZoom(vtkRenciMultiTouch* multiTouch)
   // Zoom the camera
   if (camera->GetParallelProjection())
     {
-    camera->SetParallelScale(camera->GetParallelScale() / zoomAmount);
+    this->ZoomCameraParallelScale(zoomAmount);
     }
   else
     {
-    camera->Dolly(zoomAmount);
+    this->DollyCamera(zoomAmount);
     }
 
-  this->Renderer->ResetCameraClippingRange();
+  this->ResetCameraClippingRange();
+  this->SceneModified = 1;
   // Render() will be called in the interactor
 }
 
@@ -170,19 +160,15 @@ void vtkRenciMultiTouchStyleCamera::OnTranslateX(vtkRenciMultiTouch* multiTouch)
 
   int numTouches = multiTouch->GetNumberOfTouchPoints();
 
-  vtkstd::vector<TouchPoint> touches;
-  touches.resize(numTouches);
-  for (int i = 0; i < numTouches; i++) 
-    {
-    touches[i] = multiTouch->GetTouchPoint(i);
-    }
+  // Read the touch points in place
+  const TouchPoint* touches = multiTouch->GetTouchPoints();
 
   int i;
-  for (i = 0; i < (int)touches.size(); i++) 
+  for (i = 0; i < numTouches; i++) 
     {
     if (touches[i].MoveLocation != 0) break;
     }
-  if (i >= (int)touches.size()) return;
+  if (i >= numTouches) return;
 
   // XXX: Magic number
   double translateSensitivity = 1000.0;
@@ -191,38 +177,27 @@ void vtkRenciMultiTouchStyleCamera::OnTranslateX(vtkRenciMultiTouch* multiTouch)
   double dx = touches[i].Direction[1] * translateSensitivity;
   double dy = 0.0; 
 
-  double viewFocus[4], focalDepth, viewPoint[3];
+  double viewFocus[4], focalDepth;
   double newPickPoint[4], oldPickPoint[4], motionVector[3];
 
+  this->ViewTransform->Update();
+
   camera->GetFocalPoint(viewFocus);
-  vtkInteractorObserver::ComputeWorldToDisplay(this->Renderer, 
-                                               viewFocus[0], viewFocus[1], viewFocus[2], 
-                                               viewFocus);
+  this->ViewTransform->WorldToDisplay(viewFocus[0], viewFocus[1], viewFocus[2], viewFocus);
   focalDepth = viewFocus[2];
 
-  vtkInteractorObserver::ComputeWorldToDisplay(this->Renderer, 
-                                               x, y, focalDepth, 
-                                               newPickPoint);
+  this->ViewTransform->WorldToDisplay(x, y, focalDepth, newPickPoint);
 
-  vtkInteractorObserver::ComputeWorldToDisplay(this->Renderer,
-                                               x + dx, y + dy, focalDepth, 
-                                               oldPickPoint);
+  this->ViewTransform->WorldToDisplay(x + dx, y + dy, focalDepth, oldPickPoint);
   
   // Camera motion is reversed
   motionVector[0] = oldPickPoint[0] - newPickPoint[0];
   motionVector[1] = oldPickPoint[1] - newPickPoint[1];
   motionVector[2] = oldPickPoint[2] - newPickPoint[2];
   
-  camera->GetFocalPoint(viewFocus);
-  camera->GetPosition(viewPoint);
-  camera->SetFocalPoint(motionVector[0] + viewFocus[0],
-                        motionVector[1] + viewFocus[1],
-                        motionVector[2] + viewFocus[2]);
-
-  camera->SetPosition(motionVector[0] + viewPoint[0],
-                      motionVector[1] + viewPoint[1],
-                      motionVector[2] + viewPoint[2]);
+  this->TranslateCamera(motionVector);
       
+  this->SceneModified = 1;
   // Render() will be called in the interactor
 }
 
@@ -233,19 +208,15 @@ void vtkRenciMultiTouchStyleCamera::OnTranslateY(vtkRenciMultiTouch* multiTouch)
 
   int numTouches = multiTouch->GetNumberOfTouchPoints();
 
-  vtkstd::vector<TouchPoint> touches;
-  touches.resize(numTouches);
-  for (int i = 0; i < numTouches; i++) 
-    {
-    touches[i] = multiTouch->GetTouchPoint(i);
-    }
+  // Read the touch points in place
+  const TouchPoint* touches = multiTouch->GetTouchPoints();
 
   int i;
-  for (i = 0; i < (int)touches.size(); i++) 
+  for (i = 0; i < numTouches; i++) 
     {
     if (touches[i].MoveLocation != 0) break;
     }
-  if (i >= (int)touches.size()) return;
+  if (i >= numTouches) return;
 
   double translateScale = 1000.0;
   double x = touches[i].Location[0];
@@ -253,131 +224,102 @@ void vtkRenciMultiTouchStyleCamera::OnTranslateY(vtkRenciMultiTouch* multiTouch)
   double dx = 0.0;
   double dy = touches[i].Direction[1] * translateScale; 
 
-  double viewFocus[4], focalDepth, viewPoint[3];
+  double viewFocus[4], focalDepth;
   double newPickPoint[4], oldPickPoint[4], motionVector[3];
 
+  this->ViewTransform->Update();
+
   camera->GetFocalPoint(viewFocus);
-  vtkInteractorObserver::ComputeWorldToDisplay(this->Renderer, 
-                                               viewFocus[0], viewFocus[1], viewFocus[2], 
-                                               viewFocus);
+  this->ViewTransform->WorldToDisplay(viewFocus[0], viewFocus[1], viewFocus[2], viewFocus);
   focalDepth = viewFocus[2];
 
-  vtkInteractorObserver::ComputeWorldToDisplay(this->Renderer, 
-                                               x, y, focalDepth, 
-                                               newPickPoint);
+  this->ViewTransform->WorldToDisplay(x, y, focalDepth, newPickPoint);
 
-  vtkInteractorObserver::ComputeWorldToDisplay(this->Renderer, 
-                                               x + dx, y + dy, focalDepth, 
-                                               oldPickPoint);
+  this->ViewTransform->WorldToDisplay(x + dx, y + dy, focalDepth, oldPickPoint);
   
   // Camera motion is reversed
   motionVector[0] = oldPickPoint[0] - newPickPoint[0];
   motionVector[1] = oldPickPoint[1] - newPickPoint[1];
   motionVector[2] = oldPickPoint[2] - newPickPoint[2];
   
-  camera->GetFocalPoint(viewFocus);
-  camera->GetPosition(viewPoint);
-  camera->SetFocalPoint(motionVector[0] + viewFocus[0],
-                        motionVector[1] + viewFocus[1],
-                        motionVector[2] + viewFocus[2]);
-
-  camera->SetPosition(motionVector[0] + viewPoint[0],
-                      motionVector[1] + viewPoint[1],
-                      motionVector[2] + viewPoint[2]);
+  this->TranslateCamera(motionVector);
       
+  this->SceneModified = 1;
   // Render() will be called in the interactor
 }
 
 //----------------------------------------------------------------------------
 void vtkRenciMultiTouchStyleCamera::OnRotateX(vtkRenciMultiTouch* multiTouch)
 {
-  vtkCamera* camera = this->Renderer->GetActiveCamera();
-
   int numTouches = multiTouch->GetNumberOfTouchPoints();
 
-  vtkstd::vector<TouchPoint> touches;
-  touches.resize(numTouches);
-  for (int i = 0; i < numTouches; i++) 
-    {
-    touches[i] = multiTouch->GetTouchPoint(i);
-    }
+  // Read the touch points in place
+  const TouchPoint* touches = multiTouch->GetTouchPoints();
 
   int i;
-  for (i = 0; i < (int)touches.size(); i++) 
+  for (i = 0; i < numTouches; i++) 
     {
     if (touches[i].MoveLocation != 0) break;
     }
-  if (i >= (int)touches.size()) return;
+  if (i >= numTouches) return;
 
   double rotateScale = 500.0;
   double dy = touches[i].Direction[1] * rotateScale; 
 
-  camera->Elevation(dy);
-  camera->OrthogonalizeViewUp();
+  this->ElevationCamera(dy);
 
-  this->Renderer->ResetCameraClippingRange();
+  this->ResetCameraClippingRange();
+  this->SceneModified = 1;
   // Render() will be called in the interactor
 }
 
 //----------------------------------------------------------------------------
 void vtkRenciMultiTouchStyleCamera::OnRotateY(vtkRenciMultiTouch* multiTouch)
 {
-  vtkCamera* camera = this->Renderer->GetActiveCamera();  
-  
   int numTouches = multiTouch->GetNumberOfTouchPoints();
 
-  vtkstd::vector<TouchPoint> touches;
-  touches.resize(numTouches);
-  for (int i = 0; i < numTouches; i++) 
-    {
-    touches[i] = multiTouch->GetTouchPoint(i);
-    }
+  // Read the touch points in place
+  const TouchPoint* touches = multiTouch->GetTouchPoints();
 
   int i;
-  for (i = 0; i < (int)touches.size(); i++) 
+  for (i = 0; i < numTouches; i++) 
     {
     if (touches[i].MoveLocation != 0) break;
     }
-  if (i >= (int)touches.size()) return;
+  if (i >= numTouches) return;
 
   double rotateScale = 500.0;
   double dy = touches[i].Direction[1] * rotateScale; 
 
-  camera->Azimuth(-dy);
-  camera->OrthogonalizeViewUp();
+  this->AzimuthCamera(-dy);
 
-  this->Renderer->ResetCameraClippingRange();
+  this->ResetCameraClippingRange();
+  this->SceneModified = 1;
   // Render() will be called in the interactor
 }
 
 //----------------------------------------------------------------------------
 void vtkRenciMultiTouchStyleCamera::OnRotateZ(vtkRenciMultiTouch* multiTouch)
 {
-  vtkCamera* camera = this->Renderer->GetActiveCamera();
-
   int numTouches = multiTouch->GetNumberOfTouchPoints();
 
-  vtkstd::vector<TouchPoint> touches;
-  touches.resize(numTouches);
-  for (int i = 0; i < numTouches; i++) 
-    {
-    touches[i] = multiTouch->GetTouchPoint(i);
-    }
+  // Read the touch points in place
+  const TouchPoint* touches = multiTouch->GetTouchPoints();
 
   int i;
-  for (i = 0; i < (int)touches.size(); i++) 
+  for (i = 0; i < numTouches; i++) 
     {
     if (touches[i].MoveLocation != 0) break;
     }
-  if (i >= (int)touches.size()) return;
+  if (i >= numTouches) return;
 
   double rotateScale = 500.0;
   double dy = touches[i].Direction[1] * 500.0; 
 
-  camera->Roll(-dy);
-  camera->OrthogonalizeViewUp();
+  this->RollCamera(-dy);
 
-  this->Renderer->ResetCameraClippingRange();
+  this->ResetCameraClippingRange();
+  this->SceneModified = 1;
   // Render() will be called in the interactor
 }
 
@@ -16,13 +16,59 @@
 
 #include "vtkVRPNAnalog.h"
 
+#include "vtkInteractionDeviceReportBuffer.h"
+#include "vtkInteractionDeviceTripleBuffer.h"
 #include "vtkObjectFactory.h"
+#include "vtkTimerLog.h"
 #include "vtkstd/vector"
 
-class vtkVRPNAnalogInternals 
+#include <math.h>
+
+struct ChannelInformation
+{
+  double Value;
+
+  // Incremented whenever the value changes
+  unsigned int ReportCount;
+
+  // Time the last report was sent, and when it arrived
+  double ReportTime;
+  double ArrivalTime;
+};
+
+class vtkVRPNAnalogInternals
 {
 public:
-  vtkstd::vector<double> Channel;
+  vtkVRPNAnalogInternals() 
+    { 
+    this->CurrentChannel = &this->Channel; 
+    this->Received = false;
+    }
+
+  // Written by the VRPN callback
+  vtkstd::vector<ChannelInformation> Channel;
+
+  // Whether the callback received a report since the channels were last 
+  // published
+  bool Received;
+
+  // Hands the channels to the render thread when polling in a separate thread
+  vtkInteractionDeviceTripleBuffer<vtkstd::vector<ChannelInformation> > PublishedChannel;
+
+  // Read by the get methods.  Points to either Channel or the front buffer 
+  // of PublishedChannel.
+  vtkstd::vector<ChannelInformation>* CurrentChannel;
+
+  // Report counts at the last event, and the resulting changed mask
+  vtkstd::vector<unsigned int> LastReportCount;
+  vtkstd::vector<unsigned int> ChangedBits;
+
+  // Every report since the last event, in batch mode
+  vtkInteractionDeviceReportBuffer<VRPNAnalogReport> BatchReports;
+
+  // Input and output of the filter
+  vtkstd::vector<double> UnfilteredValue;
+  vtkstd::vector<double> FilteredValue;
 };
 
 vtkCxxRevisionMacro(vtkVRPNAnalog, "$Revision: 1.0 $");
@@ -38,6 +84,8 @@ vtkVRPNAnalog::vtkVRPNAnalog()
 
   this->Analog = NULL;
 
+  this->Filter = NULL;
+
   this->SetNumberOfChannels(1);
 }
 
@@ -46,6 +94,8 @@ vtkVRPNAnalog::~vtkVRPNAnalog()
 {
   if (this->Analog) delete this->Analog;
 
+  this->SetFilter(NULL);
+
   delete this->Internals;
 }
 
@@ -60,7 +110,7 @@ int vtkVRPNAnalog::Initialize()
     }
 
   // Create the VRPN analog remote 
-  this->Analog = new vrpn_Analog_Remote(this->DeviceName);
+  this->Analog = new vrpn_Analog_Remote(this->DeviceName, this->GetVRPNConnection());
 
   // Set up the analog callback
   if (this->Analog->register_change_handler(this, HandleAnalog) == -1)
@@ -77,30 +127,179 @@ void vtkVRPNAnalog::Update()
 {
   if (this->Analog)
     {
-    this->Analog->mainloop();
+    if (!this->UpdateConnection()) this->Analog->mainloop();
     }
 }
 
 //----------------------------------------------------------------------------
 void vtkVRPNAnalog::InvokeInteractionEvent() 
 {
-  if (this->Analog)
+  if (!this->Analog) return;
+
+  this->ReportTime = 0.0;
+  this->ArrivalTime = 0.0;
+
+  if (this->BatchMode)
+    {
+    VRPNAnalogBatch batch;
+    batch.NumberOfReports = this->Internals->BatchReports.Drain();
+    batch.Reports = this->Internals->BatchReports.GetBatch();
+
+    if (batch.NumberOfReports > 0)
+      {
+      this->InvokeEvent(vtkVRPNDevice::AnalogBatchEvent, &batch);
+      }
+    }
+
+  const vtkstd::vector<ChannelInformation>& channels = *this->Internals->CurrentChannel;
+  vtkstd::vector<unsigned int>& lastReportCount = this->Internals->LastReportCount;
+  vtkstd::vector<unsigned int>& changedBits = this->Internals->ChangedBits;
+
+  int numChannels = channels.size() < lastReportCount.size() ? channels.size() : lastReportCount.size();
+
+  // Only invoke the event for channels that changed since the last one
+  changedBits.assign(numChannels / 32 + 1, 0);
+  bool changed = false;
+  for (int i = 0; i < numChannels; i++)
+    {
+    if (channels[i].ReportCount != lastReportCount[i])
+      {
+      lastReportCount[i] = channels[i].ReportCount;
+      changedBits[i / 32] |= 1u << (i % 32);
+      changed = true;
+
+      // Keep the oldest report for measuring latency
+      if (this->ArrivalTime == 0.0 || channels[i].ArrivalTime < this->ArrivalTime)
+        {
+        this->ReportTime = channels[i].ReportTime;
+        this->ArrivalTime = channels[i].ArrivalTime;
+        }
+      }
+    }
+
+  // Filter all channels, and keep updating channels whose filtered values
+  // are still catching up
+  if (this->Filter && numChannels > 0)
+    {
+    vtkstd::vector<double>& unfiltered = this->Internals->UnfilteredValue;
+    vtkstd::vector<double>& filtered = this->Internals->FilteredValue;
+    unfiltered.resize(channels.size());
+    filtered.resize(channels.size());
+
+    for (unsigned int i = 0; i < channels.size(); i++) unfiltered[i] = channels[i].Value;
+
+    this->Filter->SetNumberOfChannels(unfiltered.size());
+    this->Filter->Filter(vtkTimerLog::GetUniversalTime(), &unfiltered[0], &filtered[0]);
+
+    for (int i = 0; i < numChannels; i++)
+      {
+      if (fabs(filtered[i] - unfiltered[i]) > this->Filter->GetTolerance())
+        {
+        changedBits[i / 32] |= 1u << (i % 32);
+        changed = true;
+        }
+      }
+    }
+
+  if (!changed) return;
+
+  VRPNChangedMask mask;
+  mask.NumberOfBits = numChannels;
+  mask.Bits = &changedBits[0];
+
+  this->InvokeEvent(vtkVRPNDevice::AnalogEvent, &mask);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNAnalog::SetThreaded(int threaded) 
+{
+  if (threaded)
+    {
+    this->Internals->PublishedChannel.Reset(this->Internals->Channel);
+    this->Internals->CurrentChannel = &this->Internals->PublishedChannel.GetFrontBuffer();
+    }
+  else
+    {
+    this->Internals->CurrentChannel = &this->Internals->Channel;
+    }
+
+  this->Superclass::SetThreaded(threaded);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNAnalog::PublishState() 
+{
+  if (!this->Internals->Received) return;
+  this->Internals->Received = false;
+
+  // Vector assignment reuses the existing storage once the sizes match
+  this->Internals->PublishedChannel.GetBackBuffer() = this->Internals->Channel;
+  this->Internals->PublishedChannel.Publish();
+}
+
+//----------------------------------------------------------------------------
+int vtkVRPNAnalog::ConsumeState() 
+{
+  int newState = this->Internals->PublishedChannel.Consume();
+  this->Internals->CurrentChannel = &this->Internals->PublishedChannel.GetFrontBuffer();
+
+  // Filtered values keep catching up without new reports
+  return newState || this->Filter != NULL;
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNAnalog::SetBatchMode(int batchMode) 
+{
+  this->Internals->BatchReports.SetCapacity(batchMode ? this->BatchCapacity : 0);
+
+  this->Superclass::SetBatchMode(batchMode);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNAnalog::AddBatchReport(const VRPNAnalogReport& report) 
+{
+  this->Internals->BatchReports.Push(report);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNAnalog::SetReportTime(double time) 
+{
+  // Analog reports always contain all channels
+  double arrivalTime = vtkTimerLog::GetUniversalTime();
+  for (unsigned int i = 0; i < this->Internals->Channel.size(); i++) 
     {
-    // XXX: Should there be a flag to check for new data?
-    this->InvokeEvent(vtkVRPNDevice::AnalogEvent);
+    this->Internals->Channel[i].ReportTime = time;
+    this->Internals->Channel[i].ArrivalTime = arrivalTime;
     }
+  this->Internals->Received = true;
 }
 
 //----------------------------------------------------------------------------
 void vtkVRPNAnalog::SetNumberOfChannels(int num) 
 {
+  if (this->Threaded)
+    {
+    vtkErrorMacro(<<"Can't change the number of channels while polling in a separate thread.");
+    return;
+    }
+
   int currentNum = this->Internals->Channel.size();
 
   this->Internals->Channel.resize(num);
 
   for (int i = currentNum; i < num; i++) 
     {
-    this->SetChannel(i, 0.0);
+    this->Internals->Channel[i].Value = 0.0;
+    this->Internals->Channel[i].ReportCount = 0;
+    this->Internals->Channel[i].ReportTime = 0.0;
+    this->Internals->Channel[i].ArrivalTime = 0.0;
+    }
+
+  // Don't report the initial values as changed
+  this->Internals->LastReportCount.resize(num);
+  for (int i = currentNum; i < num; i++) 
+    {
+    this->Internals->LastReportCount[i] = this->Internals->Channel[i].ReportCount;
     }
 }
 
@@ -113,13 +312,51 @@ int vtkVRPNAnalog::GetNumberOfChannels()
 //----------------------------------------------------------------------------
 void vtkVRPNAnalog::SetChannel(int channel, double value)
 {
-  this->Internals->Channel[channel] = value;
+  // Analog devices report all channels at once, so only count actual changes
+  if (this->Internals->Channel[channel].Value != value)
+    {
+    this->Internals->Channel[channel].Value = value;
+    this->Internals->Channel[channel].ReportCount++;
+    }
 }
 
 //----------------------------------------------------------------------------
 double vtkVRPNAnalog::GetChannel(int channel)
 {
-  return this->Internals->Channel[channel];
+  if (this->Filter && 
+      this->Internals->FilteredValue.size() == this->Internals->CurrentChannel->size())
+    {
+    return this->Internals->FilteredValue[channel];
+    }
+
+  return (*this->Internals->CurrentChannel)[channel].Value;
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNAnalog::SetFilter(vtkDeviceOneEuroFilter* filter)
+{
+  if (this->Filter == filter)
+    {
+    return;
+    }
+
+  if (this->Filter != NULL) 
+    {
+    this->Filter->UnRegister(this);
+    }
+
+  this->Filter = filter;
+
+  if (this->Filter != NULL) 
+    {
+    this->Filter->Register(this);
+    this->Filter->Reset();
+    }
+
+  // Don't use filtered values from a previous filter
+  this->Internals->FilteredValue.clear();
+
+  this->Modified();
 }
 
 //----------------------------------------------------------------------------
@@ -132,6 +369,17 @@ void VRPN_CALLBACK HandleAnalog(void* userData, const vrpn_ANALOGCB a) {
     {
     analog->SetChannel(i, a.channel[i]);
     }
+
+  analog->SetReportTime(a.msg_time.tv_sec + a.msg_time.tv_usec * 1.0e-6);
+
+  if (analog->GetBatchMode())
+    {
+    VRPNAnalogReport report;
+    report.Time = a.msg_time.tv_sec + a.msg_time.tv_usec * 1.0e-6;
+    report.NumberOfChannels = num;
+    for (int i = 0; i < num; i++) report.Channel[i] = a.channel[i];
+    analog->AddBatchReport(report);
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -143,7 +391,8 @@ void vtkVRPNAnalog::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Channel: ";
   for (unsigned int i = 0; i < this->Internals->Channel.size(); i++) 
     {
-    os << this->Internals->Channel[i] << " ";
+    os << this->Internals->Channel[i].Value << " ";
     }
   os << "\n";
+  os << indent << "Filter: " << this->Filter << "\n";
 }
@@ -29,11 +29,32 @@
 
 #include "vtkVRPNDevice.h"
 
+#include "vtkDeviceOneEuroFilter.h"
+
 #include <vrpn_Analog.h>
 
 // Holds vtkstd member variables, which must be hidden
 class vtkVRPNAnalogInternals;
 
+//BTX
+// A single analog report, kept in batch mode.  Holds the first 
+// NumberOfChannels channels of the report.  Time is the VRPN message time 
+// in seconds.
+struct VRPNAnalogReport
+{
+  double Time;
+  int NumberOfChannels;
+  double Channel[vrpn_CHANNEL_MAX];
+};
+
+// Passed as callData with vtkVRPNDevice::AnalogBatchEvent
+struct VRPNAnalogBatch
+{
+  int NumberOfReports;
+  const VRPNAnalogReport* Reports;
+};
+//ETX
+
 class VTK_INTERACTIONDEVICE_EXPORT vtkVRPNAnalog : public vtkVRPNDevice
 {
 public:
@@ -50,11 +71,32 @@ public:
   virtual void Update();
 
   // Description:
-  // Invoke vrpnDevice::AnalogEvent for observers to listen for
+  // Invoke vrpnDevice::AnalogEvent for observers to listen for, if any
+  // channel has changed since the last event
   virtual void InvokeInteractionEvent();
 
   // Description:
-  // The number of channels to use
+  // Hand the analog information to the render thread when updated from 
+  // the vtkDeviceInteractor polling thread
+  virtual void SetThreaded(int threaded);
+  virtual void PublishState();
+  virtual int ConsumeState();
+
+  // Description:
+  // Allocate the report buffer when batch mode is turned on
+  virtual void SetBatchMode(int batchMode);
+
+  //BTX
+  // Description:
+  // Keep a report for the next vtkVRPNDevice::AnalogBatchEvent.  Called by 
+  // the VRPN callback in batch mode.
+  void AddBatchReport(const VRPNAnalogReport& report);
+  //ETX
+
+  // Description:
+  // The number of channels to use.  Only change it while the 
+  // vtkDeviceInteractor polling thread is stopped, since the polling 
+  // thread writes to the channels.
   void SetNumberOfChannels(int num);
   int GetNumberOfChannels();
 
@@ -63,12 +105,28 @@ public:
   void SetChannel(int channel, double value);
   double GetChannel(int channel);
 
+  // Description:
+  // Filter applied to all channels before each analog event, with one 
+  // filter channel per channel.  GetChannel() then returns filtered 
+  // values.  Batch reports are not filtered.  Channels keep being 
+  // reported as changed until their filtered values settle.  The filter's
+  // number of channels is set to match.
+  void SetFilter(vtkDeviceOneEuroFilter* filter);
+  vtkGetObjectMacro(Filter,vtkDeviceOneEuroFilter);
+
+  // Description:
+  // Record when the last report was sent, in seconds, and that it arrived 
+  // now.  Called by the VRPN callback.
+  void SetReportTime(double time);
+
 protected:
   vtkVRPNAnalog();
   ~vtkVRPNAnalog();
 
   vrpn_Analog_Remote* Analog;
 
+  vtkDeviceOneEuroFilter* Filter;
+
   vtkVRPNAnalogInternals* Internals;
 
 private:
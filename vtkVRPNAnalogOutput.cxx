@@ -16,15 +16,28 @@
 
 #include "vtkVRPNAnalogOutput.h"
 
+#include "vtkCriticalSection.h"
 #include "vtkObjectFactory.h"
 #include "vtkstd/vector"
 
+class vtkVRPNAnalogOutputInternals
+{
+public:
+  // Channel requests waiting for the polling thread
+  vtkstd::vector<int> PendingChannels;
+  vtkstd::vector<double> PendingValues;
+
+  vtkSimpleCriticalSection PendingLock;
+};
+
 vtkCxxRevisionMacro(vtkVRPNAnalogOutput, "$Revision: 1.0 $");
 vtkStandardNewMacro(vtkVRPNAnalogOutput);
 
 //----------------------------------------------------------------------------
 vtkVRPNAnalogOutput::vtkVRPNAnalogOutput() 
 {
+  this->Internals = new vtkVRPNAnalogOutputInternals();
+
   this->AnalogOutput = NULL;
 }
 
@@ -32,6 +45,8 @@ vtkVRPNAnalogOutput::vtkVRPNAnalogOutput()
 vtkVRPNAnalogOutput::~vtkVRPNAnalogOutput() 
 {
   if (this->AnalogOutput) delete this->AnalogOutput;
+
+  delete this->Internals;
 }
 
 //----------------------------------------------------------------------------
@@ -45,7 +60,7 @@ int vtkVRPNAnalogOutput::Initialize()
     }
 
   // Create the VRPN analog remote 
-  this->AnalogOutput = new vrpn_Analog_Output_Remote(this->DeviceName);
+  this->AnalogOutput = new vrpn_Analog_Output_Remote(this->DeviceName, this->GetVRPNConnection());
 
   return 1;
 }
@@ -55,14 +70,38 @@ void vtkVRPNAnalogOutput::Update()
 {
   if (this->AnalogOutput)
     {
-    this->AnalogOutput->mainloop();
+    // Send requests queued from the render thread
+    this->Internals->PendingLock.Lock();
+    for (unsigned int i = 0; i < this->Internals->PendingChannels.size(); i++)
+      {
+      this->AnalogOutput->request_change_channel_value(this->Internals->PendingChannels[i], 
+                                                       this->Internals->PendingValues[i]);
+      }
+    this->Internals->PendingChannels.clear();
+    this->Internals->PendingValues.clear();
+    this->Internals->PendingLock.Unlock();
+
+    if (!this->UpdateConnection()) this->AnalogOutput->mainloop();
     }
 }
 
 //----------------------------------------------------------------------------
 void vtkVRPNAnalogOutput::SetChannel(int channel, double value)
 {
-  this->AnalogOutput->request_change_channel_value(channel, value);
+  if (!this->AnalogOutput) return;
+
+  if (this->Threaded)
+    {
+    // VRPN remotes are not thread safe, so leave it to the polling thread
+    this->Internals->PendingLock.Lock();
+    this->Internals->PendingChannels.push_back(channel);
+    this->Internals->PendingValues.push_back(value);
+    this->Internals->PendingLock.Unlock();
+    }
+  else
+    {
+    this->AnalogOutput->request_change_channel_value(channel, value);
+    }
 }
 
 //----------------------------------------------------------------------------
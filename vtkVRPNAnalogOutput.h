@@ -54,7 +54,8 @@ public:
   virtual void InvokeInteractionEvent() {}
 
   // Description:
-  // Set the analog information
+  // Set the analog information.  When polled from the vtkDeviceInteractor
+  // polling thread, requests are queued and sent by the next Update().
   void SetChannel(int channel, double value);
 
 protected:
@@ -63,6 +64,8 @@ protected:
 
   vrpn_Analog_Output_Remote* AnalogOutput;
 
+  vtkVRPNAnalogOutputInternals* Internals;
+
 private:
   vtkVRPNAnalogOutput(const vtkVRPNAnalogOutput&);  // Not implemented.
   void operator=(const vtkVRPNAnalogOutput&);  // Not implemented.
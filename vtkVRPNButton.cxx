@@ -16,13 +16,60 @@
 
 #include "vtkVRPNButton.h"
 
+#include "vtkCriticalSection.h"
+#include "vtkInteractionDeviceReportBuffer.h"
+#include "vtkInteractionDeviceTripleBuffer.h"
 #include "vtkObjectFactory.h"
+#include "vtkTimerLog.h"
 #include "vtkstd/vector"
 
+struct ButtonInformation
+{
+  bool State;
+
+  // Incremented whenever the button is set
+  unsigned int ReportCount;
+
+  // Time the last report was sent, and when it arrived
+  double ReportTime;
+  double ArrivalTime;
+};
+
 class vtkVRPNButtonInternals
 {
 public:
-  vtkstd::vector<bool> Buttons;
+  vtkVRPNButtonInternals() 
+    { 
+    this->CurrentButtons = &this->Buttons; 
+    this->Received = false;
+    }
+
+  // Written by the VRPN callback
+  vtkstd::vector<ButtonInformation> Buttons;
+
+  // Whether the callback received a report since the buttons were last 
+  // published
+  bool Received;
+
+  // Hands the buttons to the render thread when polling in a separate thread
+  vtkInteractionDeviceTripleBuffer<vtkstd::vector<ButtonInformation> > PublishedButtons;
+
+  // Read by the get methods.  Points to either Buttons or the front buffer 
+  // of PublishedButtons.
+  vtkstd::vector<ButtonInformation>* CurrentButtons;
+
+  // Report counts at the last event, and the resulting changed mask
+  vtkstd::vector<unsigned int> LastReportCount;
+  vtkstd::vector<unsigned int> ChangedBits;
+
+  // Every report since the last event, in batch mode
+  vtkInteractionDeviceReportBuffer<VRPNButtonReport> BatchReports;
+
+  // Toggle requests waiting for the polling thread
+  vtkstd::vector<int> PendingButtons;
+  vtkstd::vector<bool> PendingToggles;
+
+  vtkSimpleCriticalSection PendingLock;
 };
 
 // Callbacks
@@ -38,6 +85,8 @@ vtkVRPNButton::vtkVRPNButton()
 
   this->Button = NULL;
 
+  this->RepeatWhilePressed = 0;
+
   this->SetNumberOfButtons(1);
 }
 
@@ -60,7 +109,7 @@ int vtkVRPNButton::Initialize()
     }
 
   // Create the VRPN Button remote 
-  this->Button = new vrpn_Button_Remote(this->DeviceName);
+  this->Button = new vrpn_Button_Remote(this->DeviceName, this->GetVRPNConnection());
 
   // Set up the Button callback
   if (this->Button->register_change_handler(this, HandleButton) == -1)
@@ -77,31 +126,166 @@ void vtkVRPNButton::Update()
 {
   if (this->Button)
     {
-    this->Button->mainloop();
+    // Send requests queued from the render thread
+    this->Internals->PendingLock.Lock();
+    for (unsigned int i = 0; i < this->Internals->PendingButtons.size(); i++)
+      {
+      this->SendToggle(this->Internals->PendingButtons[i], 
+                       this->Internals->PendingToggles[i]);
+      }
+    this->Internals->PendingButtons.clear();
+    this->Internals->PendingToggles.clear();
+    this->Internals->PendingLock.Unlock();
+
+    if (!this->UpdateConnection()) this->Button->mainloop();
     }
 }
 
 //----------------------------------------------------------------------------
 void vtkVRPNButton::InvokeInteractionEvent() 
 {
-  if (this->Button)
+  if (!this->Button) return;
+
+  this->ReportTime = 0.0;
+  this->ArrivalTime = 0.0;
+
+  if (this->BatchMode)
     {
-    // XXX: Should there be a flag to check for new data?
-    this->InvokeEvent(vtkVRPNDevice::ButtonEvent);
+    VRPNButtonBatch batch;
+    batch.NumberOfReports = this->Internals->BatchReports.Drain();
+    batch.Reports = this->Internals->BatchReports.GetBatch();
+
+    if (batch.NumberOfReports > 0)
+      {
+      this->InvokeEvent(vtkVRPNDevice::ButtonBatchEvent, &batch);
+      }
     }
+
+  const vtkstd::vector<ButtonInformation>& buttons = *this->Internals->CurrentButtons;
+  vtkstd::vector<unsigned int>& lastReportCount = this->Internals->LastReportCount;
+  vtkstd::vector<unsigned int>& changedBits = this->Internals->ChangedBits;
+
+  int numButtons = buttons.size() < lastReportCount.size() ? buttons.size() : lastReportCount.size();
+
+  // Only invoke the event for buttons that received reports since the last 
+  // one, or while a button is held if requested
+  changedBits.assign(numButtons / 32 + 1, 0);
+  bool changed = false;
+  bool pressed = false;
+  for (int i = 0; i < numButtons; i++)
+    {
+    if (buttons[i].ReportCount != lastReportCount[i])
+      {
+      lastReportCount[i] = buttons[i].ReportCount;
+      changedBits[i / 32] |= 1u << (i % 32);
+      changed = true;
+
+      // Keep the oldest report for measuring latency
+      if (this->ArrivalTime == 0.0 || buttons[i].ArrivalTime < this->ArrivalTime)
+        {
+        this->ReportTime = buttons[i].ReportTime;
+        this->ArrivalTime = buttons[i].ArrivalTime;
+        }
+      }
+
+    pressed = pressed || buttons[i].State;
+    }
+
+  if (!changed && !(this->RepeatWhilePressed && pressed)) return;
+
+  VRPNChangedMask mask;
+  mask.NumberOfBits = numButtons;
+  mask.Bits = &changedBits[0];
+
+  this->InvokeEvent(vtkVRPNDevice::ButtonEvent, &mask);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNButton::SetThreaded(int threaded) 
+{
+  if (threaded)
+    {
+    this->Internals->PublishedButtons.Reset(this->Internals->Buttons);
+    this->Internals->CurrentButtons = &this->Internals->PublishedButtons.GetFrontBuffer();
+    }
+  else
+    {
+    this->Internals->CurrentButtons = &this->Internals->Buttons;
+    }
+
+  this->Superclass::SetThreaded(threaded);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNButton::PublishState() 
+{
+  if (!this->Internals->Received) return;
+  this->Internals->Received = false;
+
+  // Vector assignment reuses the existing storage once the sizes match
+  this->Internals->PublishedButtons.GetBackBuffer() = this->Internals->Buttons;
+  this->Internals->PublishedButtons.Publish();
+}
+
+//----------------------------------------------------------------------------
+int vtkVRPNButton::ConsumeState() 
+{
+  int newState = this->Internals->PublishedButtons.Consume();
+  this->Internals->CurrentButtons = &this->Internals->PublishedButtons.GetFrontBuffer();
+
+  // Held buttons repeat the event without new reports
+  return newState || this->RepeatWhilePressed;
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNButton::SetBatchMode(int batchMode) 
+{
+  this->Internals->BatchReports.SetCapacity(batchMode ? this->BatchCapacity : 0);
+
+  this->Superclass::SetBatchMode(batchMode);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNButton::AddBatchReport(const VRPNButtonReport& report) 
+{
+  this->Internals->BatchReports.Push(report);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNButton::SetReportTime(int button, double time) 
+{
+  this->Internals->Buttons[button].ReportTime = time;
+  this->Internals->Buttons[button].ArrivalTime = vtkTimerLog::GetUniversalTime();
+  this->Internals->Received = true;
 }
 
 //----------------------------------------------------------------------------
 void vtkVRPNButton::SetNumberOfButtons(int num) 
 {
+  if (this->Threaded)
+    {
+    vtkErrorMacro(<<"Can't change the number of buttons while polling in a separate thread.");
+    return;
+    }
+
   int currentNum = this->Internals->Buttons.size();
 
   this->Internals->Buttons.resize(num);
 
   for (int i = currentNum; i < num; i++) 
     {
+    this->Internals->Buttons[i].ReportCount = 0;
+    this->Internals->Buttons[i].ReportTime = 0.0;
+    this->Internals->Buttons[i].ArrivalTime = 0.0;
     this->SetButton(i, false);
     }
+
+  // Don't report the initial values as changed
+  this->Internals->LastReportCount.resize(num);
+  for (int i = currentNum; i < num; i++) 
+    {
+    this->Internals->LastReportCount[i] = this->Internals->Buttons[i].ReportCount;
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -113,13 +297,14 @@ int vtkVRPNButton::GetNumberOfButtons()
 //----------------------------------------------------------------------------
 void vtkVRPNButton::SetButton(int button, bool value)
 {
-  this->Internals->Buttons[button] = value;
+  this->Internals->Buttons[button].State = value;
+  this->Internals->Buttons[button].ReportCount++;
 }
 
 //----------------------------------------------------------------------------
 bool vtkVRPNButton::GetButton(int button)
 {
-  return this->Internals->Buttons[button];
+  return (*this->Internals->CurrentButtons)[button].State;
 }
 
 //----------------------------------------------------------------------------
@@ -127,6 +312,23 @@ void vtkVRPNButton::SetToggle(int button, bool toggle)
 {
   if (!this->Button) return;
 
+  if (this->Threaded)
+    {
+    // VRPN remotes are not thread safe, so leave it to the polling thread
+    this->Internals->PendingLock.Lock();
+    this->Internals->PendingButtons.push_back(button);
+    this->Internals->PendingToggles.push_back(toggle);
+    this->Internals->PendingLock.Unlock();
+    }
+  else
+    {
+    this->SendToggle(button, toggle);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNButton::SendToggle(int button, bool toggle) 
+{
   if (toggle) this->Button->set_toggle(button, vrpn_BUTTON_TOGGLE_ON);
   else this->Button->set_momentary(button);
 }
@@ -138,6 +340,16 @@ void VRPN_CALLBACK HandleButton(void* userData, const vrpn_BUTTONCB b) {
   if (b.button < button->GetNumberOfButtons())
     {
     button->SetButton(b.button, b.state != 0);
+    button->SetReportTime(b.button, b.msg_time.tv_sec + b.msg_time.tv_usec * 1.0e-6);
+
+    if (button->GetBatchMode())
+      {
+      VRPNButtonReport report;
+      report.Button = b.button;
+      report.State = b.state != 0;
+      report.Time = b.msg_time.tv_sec + b.msg_time.tv_usec * 1.0e-6;
+      button->AddBatchReport(report);
+      }
     }
 }
 
@@ -148,10 +360,12 @@ void vtkVRPNButton::PrintSelf(ostream& os, vtkIndent indent)
 
   os << indent << "Button: "; Button->print();
 
+  os << indent << "RepeatWhilePressed: " << this->RepeatWhilePressed << "\n";
+
   os << indent << "Buttons: ";
   for (unsigned int i = 0; i < this->Internals->Buttons.size(); i++) 
     {
-    os << this->Internals->Buttons[i] << " ";
+    os << this->Internals->Buttons[i].State << " ";
     }
   os << "\n";
 }
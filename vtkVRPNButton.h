@@ -34,6 +34,24 @@
 // Holds vtkstd member variables, which must be hidden
 class vtkVRPNButtonInternals;
 
+//BTX
+// A single button report, kept in batch mode.  Time is the VRPN message 
+// time in seconds.
+struct VRPNButtonReport
+{
+  int Button;
+  bool State;
+  double Time;
+};
+
+// Passed as callData with vtkVRPNDevice::ButtonBatchEvent
+struct VRPNButtonBatch
+{
+  int NumberOfReports;
+  const VRPNButtonReport* Reports;
+};
+//ETX
+
 class VTK_INTERACTIONDEVICE_EXPORT vtkVRPNButton : public vtkVRPNDevice
 {
 public:
@@ -50,11 +68,40 @@ public:
   virtual void Update();
 
   // Description:
-  // Invoke vrpnDevice::ButtonEvent for observers to listen for
+  // Invoke vrpnDevice::ButtonEvent for observers to listen for, if any 
+  // button has been reported since the last event
   virtual void InvokeInteractionEvent();
 
   // Description:
-  // The number of buttons to use
+  // Also invoke vtkVRPNDevice::ButtonEvent on every update while any button 
+  // is pressed, with no buttons marked as changed.  Useful for styles that 
+  // act continuously while a button is held.  Default is off.
+  vtkSetMacro(RepeatWhilePressed,int);
+  vtkGetMacro(RepeatWhilePressed,int);
+  vtkBooleanMacro(RepeatWhilePressed,int);
+
+  // Description:
+  // Hand the button information to the render thread when updated from 
+  // the vtkDeviceInteractor polling thread
+  virtual void SetThreaded(int threaded);
+  virtual void PublishState();
+  virtual int ConsumeState();
+
+  // Description:
+  // Allocate the report buffer when batch mode is turned on
+  virtual void SetBatchMode(int batchMode);
+
+  //BTX
+  // Description:
+  // Keep a report for the next vtkVRPNDevice::ButtonBatchEvent.  Called by 
+  // the VRPN callback in batch mode.
+  void AddBatchReport(const VRPNButtonReport& report);
+  //ETX
+
+  // Description:
+  // The number of buttons to use.  Only change it while the 
+  // vtkDeviceInteractor polling thread is stopped, since the polling 
+  // thread writes to the buttons.
   void SetNumberOfButtons(int num);
   int GetNumberOfButtons();
 
@@ -63,8 +110,15 @@ public:
   void SetButton(int button, bool value);
   bool GetButton(int button);
 
+  // Description:
+  // Record when the last report for the button was sent, in seconds, and 
+  // that it arrived now.  Called by the VRPN callback.
+  void SetReportTime(int button, double time);
+
   // Description:
   // Use toggle buttons or not.  Will have no effect until the device is initialized.
+  // While the vtkDeviceInteractor polling thread is running, the request is 
+  // queued and sent by the polling thread on its next update.
   void SetToggle(int button, bool toggle);
 
 protected:
@@ -73,8 +127,14 @@ protected:
 
   vrpn_Button_Remote* Button;
 
+  int RepeatWhilePressed;
+
   vtkVRPNButtonInternals* Internals;
 
+  // Description:
+  // Send a toggle request to the VRPN server
+  void SendToggle(int button, bool toggle);
+
 private:
   vtkVRPNButton(const vtkVRPNButton&);  // Not implemented.
   void operator=(const vtkVRPNButton&);  // Not implemented.
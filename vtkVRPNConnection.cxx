@@ -0,0 +1,81 @@
+/*=========================================================================
+
+  Name:        vtkVRPNConnection.cxx
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0.
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+=========================================================================*/
+
+#include "vtkVRPNConnection.h"
+
+#include "vtkObjectFactory.h"
+
+vtkCxxRevisionMacro(vtkVRPNConnection, "$Revision: 1.0 $");
+vtkStandardNewMacro(vtkVRPNConnection);
+
+//----------------------------------------------------------------------------
+vtkVRPNConnection::vtkVRPNConnection()
+{
+  this->ServerName = NULL;
+  this->Connection = NULL;
+  this->Generation = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkVRPNConnection::~vtkVRPNConnection()
+{
+  // Remotes created with the connection hold their own references
+  if (this->Connection) this->Connection->removeReference();
+
+  if (this->ServerName)
+    {
+    delete [] this->ServerName;
+    }
+}
+
+//----------------------------------------------------------------------------
+vrpn_Connection* vtkVRPNConnection::GetConnection()
+{
+  if (!this->Connection)
+    {
+    if (this->ServerName == NULL)
+      {
+      vtkErrorMacro(<<"ServerName not set.");
+      return NULL;
+      }
+
+    // Adds a reference for us
+    this->Connection = vrpn_get_connection_by_name(this->ServerName);
+    }
+
+  return this->Connection;
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNConnection::Update()
+{
+  if (this->Connection)
+    {
+    this->Connection->mainloop();
+    }
+
+  this->Generation++;
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNConnection::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "ServerName: " << (this->ServerName ? this->ServerName : "(none)") << "\n";
+  os << indent << "Connection: " << this->Connection << "\n";
+  os << indent << "Generation: " << this->Generation << "\n";
+}
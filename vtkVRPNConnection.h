@@ -0,0 +1,86 @@
+/*=========================================================================
+
+  Name:        vtkVRPNConnection.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0.
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+=========================================================================*/
+// .NAME vtkVRPNConnection
+// .SECTION Description
+// vtkVRPNConnection holds a connection to a Virtual Reality Peripheral
+// Network (VRPN: http://www.cs.unc.edu/Research/vrpn/) server that can be
+// shared by several vtkVRPNDevices, e.g. the analog, button, and analog
+// output of a single Wii Remote.  Without it, each device services the
+// connection in its own Update(), so a connection with several devices is
+// polled several times per frame.  With it, the connection is serviced
+// once for each round of device updates, and the messages received are
+// dispatched to all devices.  Set it on each device with
+// vtkVRPNDevice::SetConnection() before calling Initialize().
+
+// .SECTION see also
+// vtkVRPNDevice
+
+#ifndef __vtkVRPNConnection_h
+#define __vtkVRPNConnection_h
+
+#include "vtkInteractionDeviceConfigure.h"
+
+#include "vtkObject.h"
+
+#include <vrpn_Connection.h>
+
+class VTK_INTERACTIONDEVICE_EXPORT vtkVRPNConnection : public vtkObject
+{
+public:
+  static vtkVRPNConnection* New();
+  vtkTypeRevisionMacro(vtkVRPNConnection,vtkObject);
+  void PrintSelf(ostream&, vtkIndent);
+
+  // Description:
+  // Set the name of the server to connect to, e.g. "localhost", or the
+  // name of any device on it, e.g. "wiimote@localhost".  Must be set before
+  // the connection is first used.
+  vtkSetStringMacro(ServerName);
+  vtkGetStringMacro(ServerName);
+
+  //BTX
+  // Description:
+  // Get the VRPN connection, connecting on first use.  Returns NULL if
+  // ServerName is not set.
+  vrpn_Connection* GetConnection();
+  //ETX
+
+  // Description:
+  // Service the connection, dispatching all messages received to the
+  // devices using it
+  void Update();
+
+  // Description:
+  // Incremented by each Update().  Used by devices to service the
+  // connection once for each round of updates.
+  vtkGetMacro(Generation,unsigned long);
+
+protected:
+  vtkVRPNConnection();
+  ~vtkVRPNConnection();
+
+  char* ServerName;
+
+  vrpn_Connection* Connection;
+
+  unsigned long Generation;
+
+private:
+  vtkVRPNConnection(const vtkVRPNConnection&);  // Not implemented.
+  void operator=(const vtkVRPNConnection&);  // Not implemented.
+};
+
+#endif
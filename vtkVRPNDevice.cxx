@@ -22,6 +22,9 @@ vtkCxxRevisionMacro(vtkVRPNDevice, "$Revision: 1.0 $");
 vtkVRPNDevice::vtkVRPNDevice() 
 {
   this->DeviceName = NULL;
+
+  this->Connection = NULL;
+  this->ConnectionGeneration = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -31,6 +34,54 @@ vtkVRPNDevice::~vtkVRPNDevice()
     {
     delete [] this->DeviceName;
     }
+
+  this->SetConnection(NULL);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNDevice::SetConnection(vtkVRPNConnection* connection)
+{
+  if (this->Connection == connection)
+    {
+    return;
+    }
+
+  if (this->Connection != NULL) 
+    {
+    this->Connection->UnRegister(this);
+    }
+
+  this->Connection = connection;
+
+  if (this->Connection != NULL) 
+    {
+    this->Connection->Register(this);
+    this->ConnectionGeneration = this->Connection->GetGeneration();
+    }
+
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+vrpn_Connection* vtkVRPNDevice::GetVRPNConnection()
+{
+  return this->Connection ? this->Connection->GetConnection() : NULL;
+}
+
+//----------------------------------------------------------------------------
+int vtkVRPNDevice::UpdateConnection()
+{
+  if (!this->Connection) return 0;
+
+  // If no other device has serviced the connection since this one last 
+  // did, a new round of updates has started
+  if (this->ConnectionGeneration == this->Connection->GetGeneration())
+    {
+    this->Connection->Update();
+    }
+  this->ConnectionGeneration = this->Connection->GetGeneration();
+
+  return 1;
 }
 
 //----------------------------------------------------------------------------
@@ -39,4 +90,5 @@ void vtkVRPNDevice::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os,indent);
 
   os << indent << "DeviceName: " << this->DeviceName << "\n";
+  os << indent << "Connection: " << this->Connection << "\n";
 }
@@ -31,6 +31,26 @@
 
 #include "vtkCommand.h"
 
+#include "vtkVRPNConnection.h"
+
+//BTX
+// Bitmask of the sensors, buttons, or channels that received new data since 
+// the last event.  Passed as callData with vtkVRPNDevice events, so 
+// observers can skip the ones that did not change.
+struct VRPNChangedMask
+{
+  int NumberOfBits;
+  const unsigned int* Bits;
+
+  bool IsChanged(int which) const
+    {
+    if (which < 0 || which >= this->NumberOfBits) return false;
+
+    return ((this->Bits[which / 32] >> (which % 32)) & 1) != 0;
+    }
+};
+//ETX
+
 class VTK_INTERACTIONDEVICE_EXPORT vtkVRPNDevice : public vtkInteractionDevice
 {
 public:
@@ -41,12 +61,26 @@ public:
   // Set the name of the device to connect to.  Must be set before Initialize().
   vtkSetStringMacro(DeviceName);
 
-  // Enumeration for VRPN events
+  // Description:
+  // Share a connection with other devices on the same server, so that it
+  // is serviced once per round of updates instead of once per device.  
+  // Must be set before Initialize().  By default each device services its
+  // own connection.
+  void SetConnection(vtkVRPNConnection* connection);
+  vtkGetObjectMacro(Connection,vtkVRPNConnection);
+
+  // Enumeration for VRPN events.  Events are only invoked when new data 
+  // has been received, and callData points to a VRPNChangedMask.  In batch
+  // mode, the batch events are invoked first with all reports received 
+  // since the last event, and callData points to the device's batch struct.
   //BTX
   enum VRPNEventIds {
       AnalogEvent = vtkCommand::UserEvent,
       ButtonEvent,
-      TrackerEvent
+      TrackerEvent,
+      AnalogBatchEvent,
+      ButtonBatchEvent,
+      TrackerBatchEvent
   };
   //ETX
 
@@ -56,6 +90,22 @@ protected:
 
   char* DeviceName;
 
+  vtkVRPNConnection* Connection;
+  unsigned long ConnectionGeneration;
+
+  //BTX
+  // Description:
+  // The connection to create the VRPN remote with, or NULL for the remote 
+  // to create its own
+  vrpn_Connection* GetVRPNConnection();
+  //ETX
+
+  // Description:
+  // Service the shared connection, if there is one, unless another device
+  // already did since this device last did.  Returns 0 if there is no 
+  // shared connection, so the remote should run its own mainloop.
+  int UpdateConnection();
+
 private:
   vtkVRPNDevice(const vtkVRPNDevice&);  // Not implemented.
   void operator=(const vtkVRPNDevice&);  // Not implemented.
@@ -16,29 +16,564 @@
 
 #include "vtkVRPNTracker.h"
 
+#include "vtkDoubleArray.h"
+#include "vtkInteractionDeviceReportBuffer.h"
+#include "vtkInteractionDeviceTripleBuffer.h"
 #include "vtkMath.h"
+#include "vtkMatrix4x4.h"
 #include "vtkObjectFactory.h"
+#include "vtkPoints.h"
+#include "vtkTimerLog.h"
 #include "vtkstd/vector"
 
-// Structure to hold tracker information
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VTK_VRPN_TRACKER_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+// Multiply quaternion a by each of the numQuaternions quaternions in b, 
+// (w, x, y, z), giving c, which may be b
+static void MultiplyQuaternions(const double a[4], int numQuaternions, 
+                                const double* b, double* c)
+{
+#ifdef VTK_VRPN_TRACKER_USE_SSE2
+  // Each quaternion is held as (w, x) and (y, z) halves
+  const __m128d aw = _mm_set1_pd(a[0]);
+  const __m128d ax = _mm_set1_pd(a[1]);
+  const __m128d ay = _mm_set1_pd(a[2]);
+  const __m128d az = _mm_set1_pd(a[3]);
+
+  // _mm_set_pd takes the high element first
+  const __m128d negPos = _mm_set_pd(1.0, -1.0);
+  const __m128d posNeg = _mm_set_pd(-1.0, 1.0);
+  const __m128d negNeg = _mm_set1_pd(-1.0);
+
+  for (int i = 0; i < numQuaternions; i++, b += 4, c += 4)
+    {
+    __m128d bwx = _mm_loadu_pd(b);
+    __m128d byz = _mm_loadu_pd(b + 2);
+    __m128d bxw = _mm_shuffle_pd(bwx, bwx, 1);
+    __m128d bzy = _mm_shuffle_pd(byz, byz, 1);
+
+    __m128d cwx = _mm_mul_pd(aw, bwx);
+    cwx = _mm_add_pd(cwx, _mm_mul_pd(ax, _mm_mul_pd(bxw, negPos)));
+    cwx = _mm_add_pd(cwx, _mm_mul_pd(ay, _mm_mul_pd(byz, negPos)));
+    cwx = _mm_add_pd(cwx, _mm_mul_pd(az, _mm_mul_pd(bzy, negNeg)));
+
+    __m128d cyz = _mm_mul_pd(aw, byz);
+    cyz = _mm_add_pd(cyz, _mm_mul_pd(ax, _mm_mul_pd(bzy, negPos)));
+    cyz = _mm_add_pd(cyz, _mm_mul_pd(ay, _mm_mul_pd(bwx, posNeg)));
+    cyz = _mm_add_pd(cyz, _mm_mul_pd(az, bxw));
+
+    _mm_storeu_pd(c, cwx);
+    _mm_storeu_pd(c + 2, cyz);
+    }
+#else
+  for (int i = 0; i < numQuaternions; i++, b += 4, c += 4)
+    {
+    double w = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+    double x = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+    double y = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+    double z = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+
+    c[0] = w;
+    c[1] = x;
+    c[2] = y;
+    c[3] = z;
+    }
+#endif
+}
+
+// Spherical linear interpolation between (w, x, y, z) quaternions
+static void SlerpQuaternion(const double* q0, const double* q1, double t, double* q)
+{
+  // Take the shorter way around
+  double dot = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+  double sign = 1.0;
+  if (dot < 0.0)
+    {
+    dot = -dot;
+    sign = -1.0;
+    }
+
+  double w0 = 1.0 - t;
+  double w1 = t;
+  if (dot < 0.9995)
+    {
+    double angle = acos(dot);
+    double sinAngle = sin(angle);
+    w0 = sin((1.0 - t) * angle) / sinAngle;
+    w1 = sin(t * angle) / sinAngle;
+    }
+  w1 *= sign;
+
+  double norm = 0.0;
+  for (int i = 0; i < 4; i++)
+    {
+    q[i] = w0 * q0[i] + w1 * q1[i];
+    norm += q[i] * q[i];
+    }
+
+  // Nearly parallel quaternions are linearly interpolated, so renormalize
+  norm = sqrt(norm);
+  for (int i = 0; i < 4; i++) q[i] /= norm;
+}
+
+// Scale the rotation angle of the unit (w, x, y, z) quaternion q by k
+static void PowerQuaternion(const double* q, double k, double* result)
+{
+  // Take the shorter way around
+  double sign = q[0] < 0.0 ? -1.0 : 1.0;
+
+  double sinHalfAngle = sqrt(q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+  if (sinHalfAngle < 1.0e-12)
+    {
+    result[0] = 1.0;
+    result[1] = result[2] = result[3] = 0.0;
+    return;
+    }
+
+  double halfAngle = k * atan2(sinHalfAngle, sign * q[0]);
+  double scale = sign * sin(halfAngle) / sinHalfAngle;
+
+  result[0] = cos(halfAngle);
+  for (int i = 1; i < 4; i++) result[i] = q[i] * scale;
+}
+
+// Don't extrapolate poses further than this, in seconds, so stale poses 
+// do not drift away
+static const double MaximumExtrapolation = 0.1;
+
+// Structure to hold tracker information for all sensors.  Each quantity is 
+// stored contiguously for all sensors, e.g. Position holds x, y, z for 
+// sensor 0, then sensor 1, etc., so that all sensors can be read at once.
+// Reports from VRPN are stored raw and only converted to world space when 
+// read, so quantities that are never read cost nothing to receive.
 struct TrackerInformation 
 {
+  enum DirtyFlags
+  {
+    PositionDirty = 1,
+    RotationDirty = 2,
+    VelocityRotationDirty = 4,
+    AccelerationRotationDirty = 8
+  };
+
+  enum DerivativeFlags
+  {
+    HasVelocity = 1,
+    HasAcceleration = 2
+  };
+
+  TrackerInformation() 
+    { 
+    this->AnyDirty = 0; 
+    this->Calibration = 0;
+    }
+
+  void Resize(int num)
+    {
+    this->RawPosition.resize(num * 3);
+    this->RawRotation.resize(num * 4);
+    this->RawVelocityRotation.resize(num * 4);
+    this->RawAccelerationRotation.resize(num * 4);
+    this->Dirty.resize(num, 0);
+    this->PoseTime.resize(num, 0.0);
+    this->Derivatives.resize(num, 0);
+
+    this->Position.resize(num * 3);
+    this->Rotation.resize(num * 4);
+
+    this->Velocity.resize(num * 3);
+    this->VelocityRotation.resize(num * 4);
+    this->VelocityRotationDelta.resize(num);
+
+    this->Acceleration.resize(num * 3);
+    this->AccelerationRotation.resize(num * 4);
+    this->AccelerationRotationDelta.resize(num);
+
+    this->ReportCount.resize(num);
+    this->ReportTime.resize(num);
+    this->ArrivalTime.resize(num);
+    }
+  int GetNumberOfSensors() const
+    {
+    return this->ReportCount.size();
+    }
+
+  void SetDirty(int sensor, unsigned char flags)
+    {
+    this->Dirty[sensor] |= flags;
+    this->AnyDirty |= flags;
+    }
+  void SetAllDirty(unsigned char flags)
+    {
+    for (int i = 0; i < this->GetNumberOfSensors(); i++) this->Dirty[i] |= flags;
+    this->AnyDirty |= flags;
+    }
+  void ClearDirty()
+    {
+    this->Dirty.assign(this->Dirty.size(), 0);
+    this->AnyDirty = 0;
+    }
+
+  // Copy the reports of another copy of the sensors with the same number of
+  // sensors.  The converted values of sensors whose raw reports are 
+  // unchanged are kept, so they are not converted again.
+  void CopyReports(const TrackerInformation& source)
+    {
+    for (int i = 0; i < this->GetNumberOfSensors(); i++)
+      {
+      unsigned char flags = 0;
+      if (!Equal(&source.RawPosition[i * 3], &this->RawPosition[i * 3], 3)) flags |= PositionDirty;
+      if (!Equal(&source.RawRotation[i * 4], &this->RawRotation[i * 4], 4)) flags |= RotationDirty;
+      if (!Equal(&source.RawVelocityRotation[i * 4], &this->RawVelocityRotation[i * 4], 4))
+        {
+        flags |= VelocityRotationDirty;
+        }
+      if (!Equal(&source.RawAccelerationRotation[i * 4], &this->RawAccelerationRotation[i * 4], 4))
+        {
+        flags |= AccelerationRotationDirty;
+        }
+      if (flags) this->SetDirty(i, flags);
+      }
+
+    // Assignment reuses the existing vector storage
+    this->RawPosition = source.RawPosition;
+    this->RawRotation = source.RawRotation;
+    this->RawVelocityRotation = source.RawVelocityRotation;
+    this->RawAccelerationRotation = source.RawAccelerationRotation;
+
+    this->PoseTime = source.PoseTime;
+    this->Derivatives = source.Derivatives;
+
+    this->Velocity = source.Velocity;
+    this->VelocityRotationDelta = source.VelocityRotationDelta;
+    this->Acceleration = source.Acceleration;
+    this->AccelerationRotationDelta = source.AccelerationRotationDelta;
+
+    this->ReportCount = source.ReportCount;
+    this->ReportTime = source.ReportTime;
+    this->ArrivalTime = source.ArrivalTime;
+    }
+  static bool Equal(const double* a, const double* b, int n)
+    {
+    for (int i = 0; i < n; i++) 
+      {
+      if (a[i] != b[i]) return false;
+      }
+    return true;
+    }
+
+  // Convert a raw VRPN (x, y, z, w) quaternion to (w, x, y, z)
+  static void ConvertQuaternion(const double* vrpnQuat, double* vtkQuat)
+    {
+    vtkQuat[0] = vrpnQuat[3];
+    vtkQuat[1] = vrpnQuat[0];
+    vtkQuat[2] = vrpnQuat[1];
+    vtkQuat[3] = vrpnQuat[2];
+    }
+
+  // Convert the raw reports for a sensor to world space if they changed 
+  // since they were last read
+  void UpdatePosition(int sensor, const double* matrix)
+    {
+    if (!(this->Dirty[sensor] & PositionDirty)) return;
+
+    const double* p = &this->RawPosition[sensor * 3];
+    double* position = &this->Position[sensor * 3];
+    for (int i = 0; i < 3; i++)
+      {
+      position[i] = matrix[i * 4] * p[0] + matrix[i * 4 + 1] * p[1] + 
+                    matrix[i * 4 + 2] * p[2] + matrix[i * 4 + 3];
+      }
+
+    this->Dirty[sensor] &= ~PositionDirty;
+    }
+  void UpdateRotation(int sensor, const double* calibration)
+    {
+    if (!(this->Dirty[sensor] & RotationDirty)) return;
+
+    double* rotation = &this->Rotation[sensor * 4];
+    ConvertQuaternion(&this->RawRotation[sensor * 4], rotation);
+    MultiplyQuaternions(calibration, 1, rotation, rotation);
+
+    this->Dirty[sensor] &= ~RotationDirty;
+    }
+  void UpdateVelocityRotation(int sensor)
+    {
+    if (!(this->Dirty[sensor] & VelocityRotationDirty)) return;
+
+    ConvertQuaternion(&this->RawVelocityRotation[sensor * 4], &this->VelocityRotation[sensor * 4]);
+
+    this->Dirty[sensor] &= ~VelocityRotationDirty;
+    }
+  void UpdateAccelerationRotation(int sensor)
+    {
+    if (!(this->Dirty[sensor] & AccelerationRotationDirty)) return;
+
+    ConvertQuaternion(&this->RawAccelerationRotation[sensor * 4], &this->AccelerationRotation[sensor * 4]);
+
+    this->Dirty[sensor] &= ~AccelerationRotationDirty;
+    }
+
+  // Convert all sensors, for the bulk accessors
+  void UpdatePositions(const double* matrix)
+    {
+    if (!(this->AnyDirty & PositionDirty)) return;
+
+    for (int i = 0; i < this->GetNumberOfSensors(); i++) this->UpdatePosition(i, matrix);
+    this->AnyDirty &= ~PositionDirty;
+    }
+  void UpdateRotations(const double* calibration)
+    {
+    if (!(this->AnyDirty & RotationDirty)) return;
+
+    for (int i = 0; i < this->GetNumberOfSensors(); i++) this->UpdateRotation(i, calibration);
+    this->AnyDirty &= ~RotationDirty;
+    }
+
+  // Raw reports, in tracker space with VRPN quaternions
+  vtkstd::vector<double> RawPosition;
+  vtkstd::vector<double> RawRotation;
+  vtkstd::vector<double> RawVelocityRotation;
+  vtkstd::vector<double> RawAccelerationRotation;
+
+  // Which converted values are out of date, per sensor and for any sensor
+  vtkstd::vector<unsigned char> Dirty;
+  unsigned char AnyDirty;
+
+  // The calibration the converted poses are for
+  unsigned int Calibration;
+
+  // Local time of the last pose, and which derivatives have been reported
+  vtkstd::vector<double> PoseTime;
+  vtkstd::vector<unsigned char> Derivatives;
+
+  vtkstd::vector<double> Position;
+  vtkstd::vector<double> Rotation;
+
+  vtkstd::vector<double> Velocity;
+  vtkstd::vector<double> VelocityRotation;
+  vtkstd::vector<double> VelocityRotationDelta;
+
+  vtkstd::vector<double> Acceleration;
+  vtkstd::vector<double> AccelerationRotation;
+  vtkstd::vector<double> AccelerationRotationDelta;
+
+  // Incremented whenever the pose of the sensor is set
+  vtkstd::vector<unsigned int> ReportCount;
+
+  // Time the last report was sent, and when it arrived
+  vtkstd::vector<double> ReportTime;
+  vtkstd::vector<double> ArrivalTime;
+};
+
+// A raw pose kept in the pose history, with its local time and a (w, x, y, z)
+// quaternion
+struct TrackerPose
+{
+  double Time;
   double Position[3];
   double Rotation[4];
+};
+
+// The last poses of a sensor.  The VRPN callback pushes poses into a 
+// lock-free ring, and the reader moves them into its own ring of the last
+// Length poses before reading, so the history is never copied with the 
+// published sensors.
+class TrackerPoseHistory
+{
+public:
+  TrackerPoseHistory() 
+    { 
+    this->Length = 0;
+    this->Count = 0;
+    this->Next = 0;
+    this->NewestTime = 0.0;
+    this->HasNewestTime = false;
+    }
 
-  double Velocity[3];
-  double VelocityRotation[4];
-  double VelocityRotationDelta;
+  // Discards the existing history.  Only call when no other thread is 
+  // using the history.
+  void SetLength(int length)
+    {
+    this->Length = length;
+    this->NewPoses.SetCapacity(length);
+    this->Poses.resize(length);
+    this->Count = 0;
+    this->Next = 0;
+    this->HasNewestTime = false;
+    }
 
-  double Acceleration[3];
-  double AccelerationRotation[4];
-  double AccelerationRotationDelta;
+  // Writer side.  Add a pose, keeping the history in time order.
+  void Push(double time, const double* position, const double* vrpnQuat)
+    {
+    if (this->Length == 0) return;
+
+    if (this->HasNewestTime && time < this->NewestTime) time = this->NewestTime;
+    this->NewestTime = time;
+    this->HasNewestTime = true;
+
+    TrackerPose pose;
+    pose.Time = time;
+    for (int i = 0; i < 3; i++) pose.Position[i] = position[i];
+    TrackerInformation::ConvertQuaternion(vrpnQuat, pose.Rotation);
+
+    this->NewPoses.Push(pose);
+    }
+
+  // Reader side.  Move the poses pushed since the last call into the ring.
+  void Update()
+    {
+    if (this->Length == 0) return;
+
+    int numPoses = this->NewPoses.Drain();
+    const TrackerPose* poses = this->NewPoses.GetBatch();
+    for (int i = 0; i < numPoses; i++)
+      {
+      this->Poses[this->Next] = poses[i];
+      this->Next = (this->Next + 1) % this->Length;
+      if (this->Count < this->Length) this->Count++;
+      }
+    }
+  int GetCount() const
+    {
+    return this->Count;
+    }
+
+  // The pose that is age poses older than the newest
+  const TrackerPose& GetPose(int age) const
+    {
+    return this->Poses[(this->Next - 1 - age + 2 * this->Length) % this->Length];
+    }
+
+private:
+  int Length;
+
+  // Only touched by the writer
+  double NewestTime;
+  bool HasNewestTime;
+
+  vtkInteractionDeviceReportBuffer<TrackerPose> NewPoses;
+
+  // Only touched by the reader
+  vtkstd::vector<TrackerPose> Poses;
+  int Count;
+  int Next;
+
+  TrackerPoseHistory(const TrackerPoseHistory&);  // Not implemented.
+  void operator=(const TrackerPoseHistory&);  // Not implemented.
 };
 
+// Copy values with the given number of components per sensor to an array
+static void CopyToArray(const vtkstd::vector<double>& values, int numComponents, 
+                        vtkDoubleArray* array)
+{
+  int numSensors = values.size() / numComponents;
+
+  array->SetNumberOfComponents(numComponents);
+  array->SetNumberOfTuples(numSensors);
+  if (numSensors > 0)
+    {
+    memcpy(array->GetPointer(0), &values[0], values.size() * sizeof(double));
+    }
+  array->Modified();
+}
+
 class vtkVRPNTrackerInternals
 {
 public:
-  vtkstd::vector<TrackerInformation> Sensors;
+  vtkVRPNTrackerInternals() 
+    { 
+    this->CurrentSensors = &this->Sensors; 
+    this->Received = false;
+    this->ClockOffset = 0.0;
+    this->HasClockOffset = false;
+    this->Calibration = 0;
+    }
+  ~vtkVRPNTrackerInternals()
+    {
+    this->ResizePoseHistories(0, 0);
+    }
+
+  // Keep a history of length poses for each of num sensors, discarding the
+  // existing ones
+  void ResizePoseHistories(int num, int length)
+    {
+    for (unsigned int i = 0; i < this->PoseHistories.size(); i++) 
+      {
+      delete this->PoseHistories[i];
+      }
+    this->PoseHistories.resize(num);
+    for (int i = 0; i < num; i++) 
+      {
+      this->PoseHistories[i] = new TrackerPoseHistory;
+      this->PoseHistories[i]->SetLength(length);
+      }
+    }
+
+  // Written by the VRPN callbacks
+  TrackerInformation Sensors;
+
+  // Whether the callbacks received a report since the sensors were last 
+  // published
+  bool Received;
+
+  // Hands the sensors to the render thread when polling in a separate thread
+  vtkInteractionDeviceTripleBuffer<TrackerInformation> PublishedSensors;
+
+  // Read by the get methods.  Points to either Sensors or the front buffer 
+  // of PublishedSensors.
+  TrackerInformation* CurrentSensors;
+
+  // Incremented whenever the calibration changes
+  unsigned int Calibration;
+
+  // Convert the current poses again with the new calibration when read.  
+  // Published copies that are not current are marked when consumed.
+  void CalibrationChanged()
+    {
+    this->Calibration++;
+    this->CurrentSensors->SetAllDirty(TrackerInformation::PositionDirty | 
+                                      TrackerInformation::RotationDirty);
+    this->CurrentSensors->Calibration = this->Calibration;
+    }
+
+  // Smallest difference seen between arrival and report times.  Adding it
+  // to a report time puts it on the local clock.
+  double ClockOffset;
+  bool HasClockOffset;
+
+  // Report counts at the last event, and the resulting changed mask
+  vtkstd::vector<unsigned int> LastReportCount;
+  vtkstd::vector<unsigned int> ChangedBits;
+
+  // Every report since the last event, in batch mode
+  vtkInteractionDeviceReportBuffer<VRPNTrackerReport> BatchReports;
+
+  // Pose history of each sensor, kept out of the published sensors
+  vtkstd::vector<TrackerPoseHistory*> PoseHistories;
+
+  // Sensors to register callbacks for, or empty for all sensors
+  vtkstd::vector<int> SubscribedSensors;
+
+  // Output of the position filter, for all sensors
+  vtkstd::vector<double> FilteredPosition;
+
+  // The filtered positions once there are any, otherwise the converted ones
+  const vtkstd::vector<double>& GetPositions(bool filtering)
+    {
+    if (filtering && this->FilteredPosition.size() == this->CurrentSensors->Position.size())
+      {
+      return this->FilteredPosition;
+      }
+
+    return this->CurrentSensors->Position;
+    }
 };
 
 // Callbacks
@@ -56,8 +591,27 @@ vtkVRPNTracker::vtkVRPNTracker()
 
   this->Tracker = NULL;
 
-  this->SetTracker2WorldTranslation(0.0, 0.0, 0.0);
-  this->SetTracker2WorldRotation(1.0, 0.0, 0.0, 0.0);
+  this->PositionFilter = NULL;
+
+  this->SubscribedReports = AllReports;
+
+  this->Tracker2WorldTranslation[0] = 0.0;
+  this->Tracker2WorldTranslation[1] = 0.0;
+  this->Tracker2WorldTranslation[2] = 0.0;
+  this->Tracker2WorldRotation[0] = 1.0;
+  this->Tracker2WorldRotation[1] = 0.0;
+  this->Tracker2WorldRotation[2] = 0.0;
+  this->Tracker2WorldRotation[3] = 0.0;
+  this->Tracker2WorldScale = 1.0;
+  this->UpdateTracker2WorldMatrix();
+
+  this->PoseHistoryLength = 0;
+
+  this->PredictionMode = PredictFromDerivatives;
+  this->PredictionTime = 0.0;
+  for (int i = 0; i < 3; i++) this->PredictedPosition[i] = 0.0;
+  this->PredictedRotation[0] = 1.0;
+  for (int i = 1; i < 4; i++) this->PredictedRotation[i] = 0.0;
 
   this->SetNumberOfSensors(1);
 }
@@ -67,6 +621,8 @@ vtkVRPNTracker::~vtkVRPNTracker()
 {
   if (this->Tracker) delete this->Tracker;
 
+  this->SetPositionFilter(NULL);
+
   delete this->Internals;
 }
 
@@ -81,53 +637,466 @@ int vtkVRPNTracker::Initialize()
     }
 
   // Create the VRPN tracker remote 
-  this->Tracker = new vrpn_Tracker_Remote(this->DeviceName);
+  this->Tracker = new vrpn_Tracker_Remote(this->DeviceName, this->GetVRPNConnection());
 
-  // Set up the tracker callbacks
-  if (this->Tracker->register_change_handler(this, HandlePosition) == -1 ||
-      this->Tracker->register_change_handler(this, HandleVelocity) == -1 ||
-      this->Tracker->register_change_handler(this, HandleAcceleration) == -1)
+  // Register the tracker callbacks for all sensors, or only for the 
+  // subscribed sensors, so VRPN doesn't call back for other sensors
+  vtkstd::vector<int> sensors = this->Internals->SubscribedSensors;
+  if (sensors.empty()) 
     {
-    vtkErrorMacro(<<"Can't register callback.");
-    return 0;
+    sensors.push_back(vrpn_ALL_SENSORS);
+    }
+  else
+    {
+    // Make room for the subscribed sensors
+    int maxSensor = 0;
+    for (unsigned int i = 0; i < sensors.size(); i++) 
+      {
+      if (sensors[i] > maxSensor) maxSensor = sensors[i];
+      }
+    if (maxSensor >= this->GetNumberOfSensors()) this->SetNumberOfSensors(maxSensor + 1);
+    }
+
+  for (unsigned int i = 0; i < sensors.size(); i++)
+    {
+    if (((this->SubscribedReports & PoseReports) && 
+         this->Tracker->register_change_handler(this, HandlePosition, sensors[i]) == -1) ||
+        ((this->SubscribedReports & VelocityReports) && 
+         this->Tracker->register_change_handler(this, HandleVelocity, sensors[i]) == -1) ||
+        ((this->SubscribedReports & AccelerationReports) && 
+         this->Tracker->register_change_handler(this, HandleAcceleration, sensors[i]) == -1))
+      {
+      vtkErrorMacro(<<"Can't register callback.");
+      return 0;
+      }
     }
 
   return 1;
 }
 
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::SubscribeSensor(int sensor) 
+{
+  if (sensor < 0) return;
+
+  for (unsigned int i = 0; i < this->Internals->SubscribedSensors.size(); i++) 
+    {
+    if (this->Internals->SubscribedSensors[i] == sensor) return;
+    }
+
+  this->Internals->SubscribedSensors.push_back(sensor);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::RemoveAllSensorSubscriptions() 
+{
+  this->Internals->SubscribedSensors.clear();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkVRPNTracker::GetNumberOfSubscribedSensors() 
+{
+  return this->Internals->SubscribedSensors.size();
+}
+
+//----------------------------------------------------------------------------
+int vtkVRPNTracker::GetSubscribedSensor(int i) 
+{
+  return this->Internals->SubscribedSensors[i];
+}
+
 //----------------------------------------------------------------------------
 void vtkVRPNTracker::Update() 
 {
   if (this->Tracker)
     {
-    this->Tracker->mainloop();
+    if (!this->UpdateConnection()) this->Tracker->mainloop();
     }
 }
 
 //----------------------------------------------------------------------------
 void vtkVRPNTracker::InvokeInteractionEvent() 
 {
-  if (this->Tracker)
+  if (!this->Tracker) return;
+
+  this->ReportTime = 0.0;
+  this->ArrivalTime = 0.0;
+
+  if (this->BatchMode)
+    {
+    int numReports = this->Internals->BatchReports.Drain();
+    VRPNTrackerReport* reports = this->Internals->BatchReports.GetBatch();
+
+    // Poses are pushed in tracker space, since the VRPN callback may run on
+    // the polling thread while the calibration changes, so convert them to
+    // world space here
+    for (int i = 0; i < numReports; i++)
+      {
+      if (reports[i].Type != VRPNTrackerReport::Position) continue;
+
+      this->TransformPoses(1, reports[i].Vector, reports[i].Rotation, 
+                           reports[i].Vector, reports[i].Rotation);
+      }
+
+    VRPNTrackerBatch batch;
+    batch.NumberOfReports = numReports;
+    batch.Reports = reports;
+
+    if (batch.NumberOfReports > 0)
+      {
+      this->InvokeEvent(vtkVRPNDevice::TrackerBatchEvent, &batch);
+      }
+    }
+
+  const TrackerInformation& sensors = *this->Internals->CurrentSensors;
+  vtkstd::vector<unsigned int>& lastReportCount = this->Internals->LastReportCount;
+  vtkstd::vector<unsigned int>& changedBits = this->Internals->ChangedBits;
+
+  int numSensors = sensors.GetNumberOfSensors() < (int)lastReportCount.size() ? 
+                   sensors.GetNumberOfSensors() : lastReportCount.size();
+
+  // Only invoke the event for sensors that received poses since the last one
+  changedBits.assign(numSensors / 32 + 1, 0);
+  bool changed = false;
+  for (int i = 0; i < numSensors; i++)
     {
-    // XXX: Should there be a flag to check for new data?
-    this->InvokeEvent(vtkVRPNDevice::TrackerEvent);
+    if (sensors.ReportCount[i] != lastReportCount[i])
+      {
+      lastReportCount[i] = sensors.ReportCount[i];
+      changedBits[i / 32] |= 1u << (i % 32);
+      changed = true;
+
+      // Keep the oldest report for measuring latency
+      if (this->ArrivalTime == 0.0 || sensors.ArrivalTime[i] < this->ArrivalTime)
+        {
+        this->ReportTime = sensors.ReportTime[i];
+        this->ArrivalTime = sensors.ArrivalTime[i];
+        }
+      }
     }
+
+  // Filter the positions of all sensors, and keep updating sensors whose
+  // filtered positions are still catching up
+  if (this->PositionFilter && numSensors > 0)
+    {
+    TrackerInformation& currentSensors = *this->Internals->CurrentSensors;
+    currentSensors.UpdatePositions(this->Tracker2WorldMatrix);
+
+    vtkstd::vector<double>& filtered = this->Internals->FilteredPosition;
+    filtered.resize(currentSensors.Position.size());
+
+    this->PositionFilter->SetNumberOfChannels(filtered.size());
+    this->PositionFilter->Filter(vtkTimerLog::GetUniversalTime(), 
+                                 &currentSensors.Position[0], &filtered[0]);
+
+    double tolerance = this->PositionFilter->GetTolerance();
+    for (int i = 0; i < numSensors; i++)
+      {
+      for (int j = i * 3; j < i * 3 + 3; j++)
+        {
+        if (fabs(filtered[j] - currentSensors.Position[j]) > tolerance)
+          {
+          changedBits[i / 32] |= 1u << (i % 32);
+          changed = true;
+          break;
+          }
+        }
+      }
+    }
+
+  if (!changed) return;
+
+  VRPNChangedMask mask;
+  mask.NumberOfBits = numSensors;
+  mask.Bits = &changedBits[0];
+
+  this->InvokeEvent(vtkVRPNDevice::TrackerEvent, &mask);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::SetThreaded(int threaded) 
+{
+  if (threaded)
+    {
+    this->Internals->PublishedSensors.Reset(this->Internals->Sensors);
+    this->Internals->CurrentSensors = &this->Internals->PublishedSensors.GetFrontBuffer();
+    }
+  else
+    {
+    // Only the published copies were converted while threaded
+    this->Internals->Sensors.SetAllDirty(TrackerInformation::PositionDirty | 
+                                         TrackerInformation::RotationDirty |
+                                         TrackerInformation::VelocityRotationDirty |
+                                         TrackerInformation::AccelerationRotationDirty);
+    this->Internals->Sensors.Calibration = this->Internals->Calibration;
+    this->Internals->CurrentSensors = &this->Internals->Sensors;
+    }
+
+  this->Superclass::SetThreaded(threaded);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::PublishState() 
+{
+  if (!this->Internals->Received) return;
+  this->Internals->Received = false;
+
+  // The back buffer keeps the poses the render thread converted when it 
+  // was the front buffer, and is marked dirty only where reports changed,
+  // so the poses stay cached until the next report
+  this->Internals->PublishedSensors.GetBackBuffer().CopyReports(this->Internals->Sensors);
+  this->Internals->PublishedSensors.Publish();
+
+  // The published copies carry the dirty flags from here on
+  this->Internals->Sensors.ClearDirty();
+}
+
+//----------------------------------------------------------------------------
+int vtkVRPNTracker::ConsumeState() 
+{
+  int newState = this->Internals->PublishedSensors.Consume();
+  this->Internals->CurrentSensors = &this->Internals->PublishedSensors.GetFrontBuffer();
+
+  // Convert poses again if the calibration changed since this copy was 
+  // last read
+  TrackerInformation& sensors = *this->Internals->CurrentSensors;
+  if (sensors.Calibration != this->Internals->Calibration)
+    {
+    sensors.SetAllDirty(TrackerInformation::PositionDirty | TrackerInformation::RotationDirty);
+    sensors.Calibration = this->Internals->Calibration;
+    }
+
+  // Filtered positions keep catching up without new reports
+  return newState || this->PositionFilter != NULL;
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::SetBatchMode(int batchMode) 
+{
+  this->Internals->BatchReports.SetCapacity(batchMode ? this->BatchCapacity : 0);
+
+  this->Superclass::SetBatchMode(batchMode);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::AddBatchReport(const VRPNTrackerReport& report) 
+{
+  this->Internals->BatchReports.Push(report);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::SetReportTime(double time, int sensor) 
+{
+  double arrivalTime = vtkTimerLog::GetUniversalTime();
+
+  this->Internals->Sensors.ReportTime[sensor] = time;
+  this->Internals->Sensors.ArrivalTime[sensor] = arrivalTime;
+  this->Internals->Received = true;
+
+  if (!this->Internals->HasClockOffset || arrivalTime - time < this->Internals->ClockOffset)
+    {
+    this->Internals->ClockOffset = arrivalTime - time;
+    this->Internals->HasClockOffset = true;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::SetTracker2WorldTranslation(double x, double y, double z) 
+{
+  this->Tracker2WorldTranslation[0] = x;
+  this->Tracker2WorldTranslation[1] = y;
+  this->Tracker2WorldTranslation[2] = z;
+
+  this->UpdateTracker2WorldMatrix();
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::SetTracker2WorldTranslation(double translation[3]) 
+{
+  this->SetTracker2WorldTranslation(translation[0], translation[1], translation[2]);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::SetTracker2WorldRotation(double w, double x, double y, double z) 
+{
+  this->Tracker2WorldRotation[0] = w;
+  this->Tracker2WorldRotation[1] = x;
+  this->Tracker2WorldRotation[2] = y;
+  this->Tracker2WorldRotation[3] = z;
+
+  this->UpdateTracker2WorldMatrix();
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::SetTracker2WorldRotation(double rotation[4]) 
+{
+  this->SetTracker2WorldRotation(rotation[0], rotation[1], rotation[2], rotation[3]);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::SetTracker2WorldScale(double scale) 
+{
+  this->Tracker2WorldScale = scale;
+
+  this->UpdateTracker2WorldMatrix();
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::UpdateTracker2WorldMatrix() 
+{
+  // Normalize the rotation, and fall back to the identity if it is not set
+  double norm = 0.0;
+  for (int i = 0; i < 4; i++) 
+    {
+    norm += this->Tracker2WorldRotation[i] * this->Tracker2WorldRotation[i];
+    }
+  norm = sqrt(norm);
+
+  for (int i = 0; i < 4; i++) 
+    {
+    this->Tracker2WorldQuaternion[i] = norm > 0.0 ? this->Tracker2WorldRotation[i] / norm : 
+                                                    (i == 0 ? 1.0 : 0.0);
+    }
+
+  double rotation[3][3];
+  vtkMath::QuaternionToMatrix3x3(this->Tracker2WorldQuaternion, rotation);
+
+  for (int i = 0; i < 3; i++) 
+    {
+    for (int j = 0; j < 3; j++) 
+      {
+      this->Tracker2WorldMatrix[i * 4 + j] = this->Tracker2WorldScale * rotation[i][j];
+      }
+    this->Tracker2WorldMatrix[i * 4 + 3] = this->Tracker2WorldTranslation[i];
+    }
+  this->Tracker2WorldMatrix[12] = 0.0;
+  this->Tracker2WorldMatrix[13] = 0.0;
+  this->Tracker2WorldMatrix[14] = 0.0;
+  this->Tracker2WorldMatrix[15] = 1.0;
+
+  // Convert the poses again with the new calibration when read
+  this->Internals->CalibrationChanged();
+
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::SetTracker2WorldMatrix(vtkMatrix4x4* matrix) 
+{
+  if (!matrix) return;
+
+  double linear[3][3];
+  for (int i = 0; i < 3; i++) 
+    {
+    for (int j = 0; j < 3; j++) 
+      {
+      linear[i][j] = matrix->Element[i][j];
+      }
+    }
+
+  // The closest rotation to a reflection is meaningless
+  double determinant = vtkMath::Determinant3x3(linear);
+  if (determinant <= 0.0)
+    {
+    vtkErrorMacro(<<"Tracker2WorldMatrix must have a positive determinant.");
+    return;
+    }
+
+  for (int i = 0; i < 4; i++) 
+    {
+    for (int j = 0; j < 4; j++) 
+      {
+      this->Tracker2WorldMatrix[i * 4 + j] = matrix->Element[i][j];
+      }
+    }
+
+  // Decompose into translation, uniform scale, and the closest rotation
+  for (int i = 0; i < 3; i++) 
+    {
+    this->Tracker2WorldTranslation[i] = matrix->Element[i][3];
+    }
+
+  this->Tracker2WorldScale = pow(determinant, 1.0 / 3.0);
+
+  double rotation[3][3];
+  vtkMath::Orthogonalize3x3(linear, rotation);
+  vtkMath::Matrix3x3ToQuaternion(rotation, this->Tracker2WorldRotation);
+
+  for (int i = 0; i < 4; i++) 
+    {
+    this->Tracker2WorldQuaternion[i] = this->Tracker2WorldRotation[i];
+    }
+
+  // Convert the poses again with the new calibration when read
+  this->Internals->CalibrationChanged();
+
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::GetTracker2WorldMatrix(vtkMatrix4x4* matrix) 
+{
+  if (!matrix) return;
+
+  matrix->DeepCopy(this->Tracker2WorldMatrix);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::TransformPoses(int numPoses, const double* positions, const double* rotations,
+                                    double* worldPositions, double* worldRotations) 
+{
+  const double* m = this->Tracker2WorldMatrix;
+
+  for (int i = 0; i < numPoses; i++, positions += 3, worldPositions += 3)
+    {
+    double x = positions[0];
+    double y = positions[1];
+    double z = positions[2];
+
+    worldPositions[0] = m[0] * x + m[1] * y + m[2] * z + m[3];
+    worldPositions[1] = m[4] * x + m[5] * y + m[6] * z + m[7];
+    worldPositions[2] = m[8] * x + m[9] * y + m[10] * z + m[11];
+    }
+
+  MultiplyQuaternions(this->Tracker2WorldQuaternion, numPoses, rotations, worldRotations);
 }
 
 //----------------------------------------------------------------------------
 void vtkVRPNTracker::SetNumberOfSensors(int num) 
 {
-  int currentNum = this->Internals->Sensors.size();
+  if (this->Threaded)
+    {
+    vtkErrorMacro(<<"Can't change the number of sensors while polling in a separate thread.");
+    return;
+    }
 
-  this->Internals->Sensors.resize(num);
+  int currentNum = this->Internals->Sensors.GetNumberOfSensors();
+
+  this->Internals->Sensors.Resize(num);
+  this->Internals->ResizePoseHistories(num, this->PoseHistoryLength);
+  for (int i = currentNum; i < num; i++) 
+    {
+    this->Internals->Sensors.ReportCount[i] = 0;
+    this->Internals->Sensors.ReportTime[i] = 0.0;
+    this->Internals->Sensors.ArrivalTime[i] = 0.0;
+    }
 
   double identityVector[3] = { 0.0, 0.0, 0.0 };
   double identityRotation[4] = { 1.0, 0.0, 0.0, 0.0 };
 
+  // VRPN quaternions are (x, y, z, w)
+  double identityVRPNRotation[4] = { 0.0, 0.0, 0.0, 1.0 };
+
   for (int i = currentNum; i < num; i++) 
     {
-    this->SetPosition(identityVector, i);
-    this->SetRotation(identityRotation, i);
+    // The raw pose is converted when read, so the calibration applies to 
+    // sensors that have not been reported yet too
+    for (int j = 0; j < 3; j++) this->Internals->Sensors.RawPosition[i * 3 + j] = identityVector[j];
+    for (int j = 0; j < 4; j++) this->Internals->Sensors.RawRotation[i * 4 + j] = identityVRPNRotation[j];
+    this->Internals->Sensors.SetDirty(i, TrackerInformation::PositionDirty | 
+                                         TrackerInformation::RotationDirty);
     
     this->SetVelocity(identityVector, i);
     this->SetVelocityRotation(identityRotation, i);
@@ -137,12 +1106,290 @@ void vtkVRPNTracker::SetNumberOfSensors(int num)
     this->SetAccelerationRotation(identityRotation, i);
     this->SetAccelerationRotationDelta(1.0, i);
     }
+
+  // Don't report the initial values as changed
+  this->Internals->LastReportCount.resize(num);
+  for (int i = currentNum; i < num; i++) 
+    {
+    this->Internals->LastReportCount[i] = this->Internals->Sensors.ReportCount[i];
+    }
 }
 
 //----------------------------------------------------------------------------
 int vtkVRPNTracker::GetNumberOfSensors() 
 {
-  return this->Internals->Sensors.size();
+  return this->Internals->Sensors.GetNumberOfSensors();
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::SetTrackerPose(const double* position, const double* quaternion, int sensor)
+{
+  TrackerInformation& sensors = this->Internals->Sensors;
+
+  for (int i = 0; i < 3; i++) sensors.RawPosition[sensor * 3 + i] = position[i];
+  for (int i = 0; i < 4; i++) sensors.RawRotation[sensor * 4 + i] = quaternion[i];
+  sensors.SetDirty(sensor, TrackerInformation::PositionDirty | TrackerInformation::RotationDirty);
+  sensors.ReportCount[sensor]++;
+
+  sensors.PoseTime[sensor] = sensors.ReportTime[sensor] + this->Internals->ClockOffset;
+  this->Internals->PoseHistories[sensor]->Push(sensors.PoseTime[sensor], position, quaternion);
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::SetPoseHistoryLength(int length)
+{
+  if (this->Threaded)
+    {
+    vtkErrorMacro(<<"Can't change the pose history length while polling in a separate thread.");
+    return;
+    }
+
+  if (length < 0) length = 0;
+
+  this->PoseHistoryLength = length;
+  this->Internals->ResizePoseHistories(this->GetNumberOfSensors(), length);
+
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::SetPositionFilter(vtkDeviceOneEuroFilter* filter)
+{
+  if (this->PositionFilter == filter)
+    {
+    return;
+    }
+
+  if (this->PositionFilter != NULL) 
+    {
+    this->PositionFilter->UnRegister(this);
+    }
+
+  this->PositionFilter = filter;
+
+  if (this->PositionFilter != NULL) 
+    {
+    this->PositionFilter->Register(this);
+    this->PositionFilter->Reset();
+    }
+
+  // Don't use filtered positions from a previous filter
+  this->Internals->FilteredPosition.clear();
+
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkVRPNTracker::GetPoseAt(double time, double position[3], double rotation[4], int sensor)
+{
+  if (sensor < 0 || sensor >= (int)this->Internals->PoseHistories.size()) return 0;
+
+  TrackerPoseHistory* history = this->Internals->PoseHistories[sensor];
+  history->Update();
+
+  int count = history->GetCount();
+  if (count == 0) return 0;
+
+  // Find the newest pose at or before the time, searching from the newest 
+  // since the time is usually recent
+  const TrackerPose* newer = &history->GetPose(0);
+  const TrackerPose* older = NULL;
+  for (int age = 0; age < count; age++)
+    {
+    const TrackerPose* pose = &history->GetPose(age);
+    if (pose->Time <= time)
+      {
+      older = pose;
+      break;
+      }
+    newer = pose;
+    }
+
+  double pos[3];
+  double quat[4];
+  if (older == NULL || older == newer)
+    {
+    // Before the oldest or after the newest pose, so use it as is
+    const TrackerPose* pose = older == NULL ? newer : older;
+    for (int i = 0; i < 3; i++) pos[i] = pose->Position[i];
+    for (int i = 0; i < 4; i++) quat[i] = pose->Rotation[i];
+    }
+  else
+    {
+    double t0 = older->Time;
+    double t1 = newer->Time;
+    double t = t1 > t0 ? (time - t0) / (t1 - t0) : 1.0;
+
+    for (int i = 0; i < 3; i++) 
+      {
+      pos[i] = (1.0 - t) * older->Position[i] + t * newer->Position[i];
+      }
+    SlerpQuaternion(older->Rotation, newer->Rotation, t, quat);
+    }
+
+  // The calibration is affine, so interpolating before applying it is the 
+  // same as interpolating world space poses
+  this->TransformPoses(1, pos, quat, position, rotation);
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkVRPNTracker::GetPredictedPose(double time, double position[3], double rotation[4], int sensor)
+{
+  TrackerInformation& sensors = *this->Internals->CurrentSensors;
+
+  if (sensor < 0 || sensor >= sensors.GetNumberOfSensors()) return 0;
+
+  // The calibration without translation, for derivatives
+  const double* m = this->Tracker2WorldMatrix;
+  const double* calibration = this->Tracker2WorldQuaternion;
+  double inverseCalibration[4] = { calibration[0], -calibration[1], -calibration[2], -calibration[3] };
+
+  double poseTime;
+  double velocity[3] = { 0.0, 0.0, 0.0 };
+  double acceleration[3] = { 0.0, 0.0, 0.0 };
+  double rotationVelocity[4] = { 1.0, 0.0, 0.0, 0.0 };
+  double rotationVelocityTime = 0.0;
+
+  TrackerPoseHistory* history = this->Internals->PoseHistories[sensor];
+  history->Update();
+
+  int count = history->GetCount();
+  bool useHistory = this->PredictionMode == PredictFromHistory || 
+                    !(sensors.Derivatives[sensor] & TrackerInformation::HasVelocity);
+
+  if (useHistory && count >= 2)
+    {
+    // Fit a constant velocity to the two newest poses
+    const TrackerPose& newer = history->GetPose(0);
+    const TrackerPose& older = history->GetPose(1);
+    double t0 = older.Time;
+    double t1 = newer.Time;
+
+    double positions[6];
+    double rotations[8];
+    for (int i = 0; i < 3; i++) 
+      {
+      positions[i] = older.Position[i];
+      positions[3 + i] = newer.Position[i];
+      }
+    for (int i = 0; i < 4; i++) 
+      {
+      rotations[i] = older.Rotation[i];
+      rotations[4 + i] = newer.Rotation[i];
+      }
+    this->TransformPoses(2, positions, rotations, positions, rotations);
+
+    poseTime = t1;
+    for (int i = 0; i < 3; i++) 
+      {
+      position[i] = positions[3 + i];
+      velocity[i] = t1 > t0 ? (positions[3 + i] - positions[i]) / (t1 - t0) : 0.0;
+      }
+    for (int i = 0; i < 4; i++) rotation[i] = rotations[4 + i];
+
+    // The rotation from the older to the newer pose
+    double inverseOlder[4] = { rotations[0], -rotations[1], -rotations[2], -rotations[3] };
+    MultiplyQuaternions(&rotations[4], 1, inverseOlder, rotationVelocity);
+    rotationVelocityTime = t1 - t0;
+    }
+  else
+    {
+    poseTime = sensors.PoseTime[sensor];
+    for (int i = 0; i < 3; i++) position[i] = this->GetPosition(sensor)[i];
+    for (int i = 0; i < 4; i++) rotation[i] = this->GetRotation(sensor)[i];
+
+    if (!useHistory)
+      {
+      // Derivatives are reported in tracker space
+      const double* v = &sensors.Velocity[sensor * 3];
+      const double* a = &sensors.Acceleration[sensor * 3];
+      bool hasAcceleration = (sensors.Derivatives[sensor] & TrackerInformation::HasAcceleration) != 0;
+      for (int i = 0; i < 3; i++)
+        {
+        velocity[i] = m[i * 4] * v[0] + m[i * 4 + 1] * v[1] + m[i * 4 + 2] * v[2];
+        if (hasAcceleration)
+          {
+          acceleration[i] = m[i * 4] * a[0] + m[i * 4 + 1] * a[1] + m[i * 4 + 2] * a[2];
+          }
+        }
+
+      // Rotate the rotation velocity into world space
+      MultiplyQuaternions(this->GetVelocityRotation(sensor), 1, inverseCalibration, rotationVelocity);
+      MultiplyQuaternions(calibration, 1, rotationVelocity, rotationVelocity);
+      rotationVelocityTime = sensors.VelocityRotationDelta[sensor];
+      }
+    }
+
+  // Extrapolate from when the pose was sent
+  double dt = time - poseTime;
+  if (dt < 0.0) dt = 0.0;
+  if (dt > MaximumExtrapolation) dt = MaximumExtrapolation;
+
+  for (int i = 0; i < 3; i++) 
+    {
+    position[i] += velocity[i] * dt + 0.5 * acceleration[i] * dt * dt;
+    }
+
+  if (rotationVelocityTime > 0.0)
+    {
+    double delta[4];
+    PowerQuaternion(rotationVelocity, dt / rotationVelocityTime, delta);
+    MultiplyQuaternions(delta, 1, rotation, rotation);
+
+    double norm = sqrt(rotation[0] * rotation[0] + rotation[1] * rotation[1] + 
+                       rotation[2] * rotation[2] + rotation[3] * rotation[3]);
+    for (int i = 0; i < 4; i++) rotation[i] /= norm;
+    }
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+double* vtkVRPNTracker::GetPredictedPosition(int sensor)
+{
+  double rotation[4];
+  this->GetPredictedPose(vtkTimerLog::GetUniversalTime() + this->PredictionTime, 
+                         this->PredictedPosition, rotation, sensor);
+
+  return this->PredictedPosition;
+}
+
+//----------------------------------------------------------------------------
+double* vtkVRPNTracker::GetPredictedRotation(int sensor)
+{
+  double position[3];
+  this->GetPredictedPose(vtkTimerLog::GetUniversalTime() + this->PredictionTime, 
+                         position, this->PredictedRotation, sensor);
+
+  return this->PredictedRotation;
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::SetTrackerVelocity(const double* velocity, const double* quaternion, 
+                                        double delta, int sensor)
+{
+  TrackerInformation& sensors = this->Internals->Sensors;
+
+  for (int i = 0; i < 3; i++) sensors.Velocity[sensor * 3 + i] = velocity[i];
+  for (int i = 0; i < 4; i++) sensors.RawVelocityRotation[sensor * 4 + i] = quaternion[i];
+  sensors.VelocityRotationDelta[sensor] = delta;
+  sensors.SetDirty(sensor, TrackerInformation::VelocityRotationDirty);
+  sensors.Derivatives[sensor] |= TrackerInformation::HasVelocity;
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::SetTrackerAcceleration(const double* acceleration, const double* quaternion, 
+                                            double delta, int sensor)
+{
+  TrackerInformation& sensors = this->Internals->Sensors;
+
+  for (int i = 0; i < 3; i++) sensors.Acceleration[sensor * 3 + i] = acceleration[i];
+  for (int i = 0; i < 4; i++) sensors.RawAccelerationRotation[sensor * 4 + i] = quaternion[i];
+  sensors.AccelerationRotationDelta[sensor] = delta;
+  sensors.SetDirty(sensor, TrackerInformation::AccelerationRotationDirty);
+  sensors.Derivatives[sensor] |= TrackerInformation::HasAcceleration;
 }
 
 //----------------------------------------------------------------------------
@@ -150,14 +1397,18 @@ void vtkVRPNTracker::SetPosition(double* position, int sensor)
 {
   for (int i = 0; i < 3; i++)
     {
-    this->Internals->Sensors[sensor].Position[i] = position[i];
+    this->Internals->Sensors.Position[sensor * 3 + i] = position[i];
     }
+  this->Internals->Sensors.Dirty[sensor] &= ~TrackerInformation::PositionDirty;
+  this->Internals->Sensors.ReportCount[sensor]++;
 }
 
 //----------------------------------------------------------------------------
 double* vtkVRPNTracker::GetPosition(int sensor)
 {
-  return this->Internals->Sensors[sensor].Position;
+  this->Internals->CurrentSensors->UpdatePosition(sensor, this->Tracker2WorldMatrix);
+
+  return const_cast<double*>(&this->Internals->GetPositions(this->PositionFilter != NULL)[sensor * 3]);
 }
 
 //----------------------------------------------------------------------------
@@ -165,14 +1416,18 @@ void vtkVRPNTracker::SetRotation(double* rotation, int sensor)
 {
   for (int i = 0; i < 4; i++)
     {
-    this->Internals->Sensors[sensor].Rotation[i] = rotation[i];
+    this->Internals->Sensors.Rotation[sensor * 4 + i] = rotation[i];
     }
+  this->Internals->Sensors.Dirty[sensor] &= ~TrackerInformation::RotationDirty;
+  this->Internals->Sensors.ReportCount[sensor]++;
 }
 
 //----------------------------------------------------------------------------
 double* vtkVRPNTracker::GetRotation(int sensor)
 {
-  return this->Internals->Sensors[sensor].Rotation;
+  this->Internals->CurrentSensors->UpdateRotation(sensor, this->Tracker2WorldQuaternion);
+
+  return &this->Internals->CurrentSensors->Rotation[sensor * 4];
 }
 
 //----------------------------------------------------------------------------
@@ -180,14 +1435,14 @@ void vtkVRPNTracker::SetVelocity(double* velocity, int sensor)
 {
   for (int i = 0; i < 3; i++)
     {
-    this->Internals->Sensors[sensor].Velocity[i] = velocity[i];
+    this->Internals->Sensors.Velocity[sensor * 3 + i] = velocity[i];
     }
 }
 
 //----------------------------------------------------------------------------
 double* vtkVRPNTracker::GetVelocity(int sensor)
 {
-  return this->Internals->Sensors[sensor].Velocity;
+  return &this->Internals->CurrentSensors->Velocity[sensor * 3];
 }
 
 //----------------------------------------------------------------------------
@@ -195,26 +1450,29 @@ void vtkVRPNTracker::SetVelocityRotation(double* rotation, int sensor)
 {
   for (int i = 0; i < 4; i++)
     {
-    this->Internals->Sensors[sensor].VelocityRotation[i] = rotation[i];
+    this->Internals->Sensors.VelocityRotation[sensor * 4 + i] = rotation[i];
     }
+  this->Internals->Sensors.Dirty[sensor] &= ~TrackerInformation::VelocityRotationDirty;
 }
 
 //----------------------------------------------------------------------------
 double* vtkVRPNTracker::GetVelocityRotation(int sensor)
 {
-  return this->Internals->Sensors[sensor].Velocity;
+  this->Internals->CurrentSensors->UpdateVelocityRotation(sensor);
+
+  return &this->Internals->CurrentSensors->VelocityRotation[sensor * 4];
 }
 
 //----------------------------------------------------------------------------
 void vtkVRPNTracker::SetVelocityRotationDelta(double delta, int sensor)
 {
-  this->Internals->Sensors[sensor].VelocityRotationDelta = delta;
+  this->Internals->Sensors.VelocityRotationDelta[sensor] = delta;
 }
 
 //----------------------------------------------------------------------------
 double vtkVRPNTracker::GetVelocityRotationDelta(int sensor)
 {
-  return this->Internals->Sensors[sensor].VelocityRotationDelta;
+  return this->Internals->CurrentSensors->VelocityRotationDelta[sensor];
 }
 
 //----------------------------------------------------------------------------
@@ -222,14 +1480,14 @@ void vtkVRPNTracker::SetAcceleration(double* acceleration, int sensor)
 {
   for (int i = 0; i < 3; i++)
     {
-    this->Internals->Sensors[sensor].Acceleration[i] = acceleration[i];
+    this->Internals->Sensors.Acceleration[sensor * 3 + i] = acceleration[i];
     }
 }
 
 //----------------------------------------------------------------------------
 double* vtkVRPNTracker::GetAcceleration(int sensor)
 {
-  return this->Internals->Sensors[sensor].Acceleration;
+  return &this->Internals->CurrentSensors->Acceleration[sensor * 3];
 }
 
 //----------------------------------------------------------------------------
@@ -237,66 +1495,136 @@ void vtkVRPNTracker::SetAccelerationRotation(double* rotation, int sensor)
 {
   for (int i = 0; i < 4; i++)
     {
-    this->Internals->Sensors[sensor].AccelerationRotation[i] = rotation[i];
+    this->Internals->Sensors.AccelerationRotation[sensor * 4 + i] = rotation[i];
     }
+  this->Internals->Sensors.Dirty[sensor] &= ~TrackerInformation::AccelerationRotationDirty;
 }
 
 //----------------------------------------------------------------------------
 double* vtkVRPNTracker::GetAccelerationRotation(int sensor)
 {
-  return this->Internals->Sensors[sensor].Acceleration;
+  this->Internals->CurrentSensors->UpdateAccelerationRotation(sensor);
+
+  return &this->Internals->CurrentSensors->AccelerationRotation[sensor * 4];
 }
 
 //----------------------------------------------------------------------------
 void vtkVRPNTracker::SetAccelerationRotationDelta(double delta, int sensor)
 {
-  this->Internals->Sensors[sensor].AccelerationRotationDelta = delta;
+  this->Internals->Sensors.AccelerationRotationDelta[sensor] = delta;
 }
 
 //----------------------------------------------------------------------------
 double vtkVRPNTracker::GetAccelerationRotationDelta(int sensor)
 {
-  return this->Internals->Sensors[sensor].AccelerationRotationDelta;
+  return this->Internals->CurrentSensors->AccelerationRotationDelta[sensor];
 }
 
 //----------------------------------------------------------------------------
-void VRPN_CALLBACK HandlePosition(void* userData, const vrpn_TRACKERCB t) {
-  vtkVRPNTracker* tracker = static_cast<vtkVRPNTracker*>(userData);
+const double* vtkVRPNTracker::GetPositionArray()
+{
+  this->Internals->CurrentSensors->UpdatePositions(this->Tracker2WorldMatrix);
 
-  if (t.sensor < tracker->GetNumberOfSensors()) 
+  const vtkstd::vector<double>& values = this->Internals->GetPositions(this->PositionFilter != NULL);
+  return values.empty() ? NULL : &values[0];
+}
+
+//----------------------------------------------------------------------------
+const double* vtkVRPNTracker::GetRotationArray()
+{
+  this->Internals->CurrentSensors->UpdateRotations(this->Tracker2WorldQuaternion);
+
+  const vtkstd::vector<double>& values = this->Internals->CurrentSensors->Rotation;
+  return values.empty() ? NULL : &values[0];
+}
+
+//----------------------------------------------------------------------------
+const double* vtkVRPNTracker::GetVelocityArray()
+{
+  const vtkstd::vector<double>& values = this->Internals->CurrentSensors->Velocity;
+  return values.empty() ? NULL : &values[0];
+}
+
+//----------------------------------------------------------------------------
+const double* vtkVRPNTracker::GetAccelerationArray()
+{
+  const vtkstd::vector<double>& values = this->Internals->CurrentSensors->Acceleration;
+  return values.empty() ? NULL : &values[0];
+}
+
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::GetPositions(vtkPoints* points)
+{
+  this->Internals->CurrentSensors->UpdatePositions(this->Tracker2WorldMatrix);
+
+  const vtkstd::vector<double>& values = this->Internals->GetPositions(this->PositionFilter != NULL);
+  int numSensors = values.size() / 3;
+
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(numSensors);
+  if (numSensors > 0)
     {
-    // Transform the position
-    double pos[3];
-    double t2wTrans[3];
-    tracker->GetTracker2WorldTranslation(t2wTrans);
-    for (int i = 0; i < 3; i++) {
-        pos[i] = t.pos[i] + t2wTrans[i];
+    memcpy(points->GetVoidPointer(0), &values[0], values.size() * sizeof(double));
     }
+  points->Modified();
+}
 
-    // Set the position for this sensor
-    tracker->SetPosition(pos, t.sensor);
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::GetPositions(vtkDoubleArray* positions)
+{
+  this->Internals->CurrentSensors->UpdatePositions(this->Tracker2WorldMatrix);
 
-    // Convert from vrpn quaternion (x, y, z, w) to vtk quaternion (w, x, y, z)
-    double vtkQuat[4];
-    vtkQuat[0] = t.quat[3];
-    vtkQuat[1] = t.quat[0];
-    vtkQuat[2] = t.quat[1];
-    vtkQuat[3] = t.quat[2];
+  CopyToArray(this->Internals->GetPositions(this->PositionFilter != NULL), 3, positions);
+}
 
-    // Transform the rotation via matrix operations.  
-    // Would be nice if VTK had quaternion operations instead...
-    double rot[3][3];
-    vtkMath::QuaternionToMatrix3x3(vtkQuat, rot);
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::GetRotations(vtkDoubleArray* rotations)
+{
+  this->Internals->CurrentSensors->UpdateRotations(this->Tracker2WorldQuaternion);
+
+  CopyToArray(this->Internals->CurrentSensors->Rotation, 4, rotations);
+}
 
-    double t2wRot[3][3];
-    vtkMath::QuaternionToMatrix3x3(tracker->GetTracker2WorldRotation(), t2wRot);
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::GetVelocities(vtkDoubleArray* velocities)
+{
+  CopyToArray(this->Internals->CurrentSensors->Velocity, 3, velocities);
+}
 
-    vtkMath::Multiply3x3(rot, t2wRot, rot);
+//----------------------------------------------------------------------------
+void vtkVRPNTracker::GetAccelerations(vtkDoubleArray* accelerations)
+{
+  CopyToArray(this->Internals->CurrentSensors->Acceleration, 3, accelerations);
+}
 
-    vtkMath::Matrix3x3ToQuaternion(rot, vtkQuat);
+//----------------------------------------------------------------------------
+void VRPN_CALLBACK HandlePosition(void* userData, const vrpn_TRACKERCB t) {
+  vtkVRPNTracker* tracker = static_cast<vtkVRPNTracker*>(userData);
 
-    // Set the rotation for this sensor
-    tracker->SetRotation(vtkQuat, t.sensor);
+  if (t.sensor < tracker->GetNumberOfSensors()) 
+    {
+    tracker->SetReportTime(t.msg_time.tv_sec + t.msg_time.tv_usec * 1.0e-6, t.sensor);
+
+    // Store the raw position and rotation for this sensor, which are 
+    // transformed to world space when read
+    tracker->SetTrackerPose(t.pos, t.quat, t.sensor);
+
+    if (tracker->GetBatchMode())
+      {
+      // Kept in tracker space until InvokeInteractionEvent(), which 
+      // converts it with the calibration at that time
+      double vtkQuat[4];
+      TrackerInformation::ConvertQuaternion(t.quat, vtkQuat);
+
+      VRPNTrackerReport report;
+      report.Type = VRPNTrackerReport::Position;
+      report.Sensor = t.sensor;
+      report.Time = t.msg_time.tv_sec + t.msg_time.tv_usec * 1.0e-6;
+      for (int i = 0; i < 3; i++) report.Vector[i] = t.pos[i];
+      for (int i = 0; i < 4; i++) report.Rotation[i] = vtkQuat[i];
+      report.RotationDelta = 0.0;
+      tracker->AddBatchReport(report);
+      }
     }
 }
 
@@ -306,22 +1634,26 @@ void VRPN_CALLBACK HandleVelocity(void* userData, const vrpn_TRACKERVELCB t) {
 
   if (t.sensor < tracker->GetNumberOfSensors()) 
     {
-    // Set the velocity for this sensor
-    tracker->SetVelocity((double*)t.vel, t.sensor);
-    
-    // Convert from vrpn quaternion (x, y, z, w) to vtk quaternion (w, x, y, z)
-    double vtkQuat[4];
-    vtkQuat[0] = t.vel_quat[1];
-    vtkQuat[1] = t.vel_quat[2];
-    vtkQuat[2] = t.vel_quat[3];
-    vtkQuat[3] = t.vel_quat[0];
-    tracker->SetVelocityRotation(vtkQuat, t.sensor);
-
-    // Set the velocity rotation for this sensor
-    tracker->SetVelocityRotation(vtkQuat, t.sensor);
-    
-    // Set the velocity rotation delta for this sensor
-    tracker->SetVelocityRotationDelta(t.vel_quat_dt, t.sensor);
+    // Store the raw velocity, velocity rotation, and velocity rotation delta
+    // for this sensor
+    tracker->SetTrackerVelocity(t.vel, t.vel_quat, t.vel_quat_dt, t.sensor);
+
+    tracker->SetReportTime(t.msg_time.tv_sec + t.msg_time.tv_usec * 1.0e-6, t.sensor);
+
+    if (tracker->GetBatchMode())
+      {
+      double vtkQuat[4];
+      TrackerInformation::ConvertQuaternion(t.vel_quat, vtkQuat);
+
+      VRPNTrackerReport report;
+      report.Type = VRPNTrackerReport::Velocity;
+      report.Sensor = t.sensor;
+      report.Time = t.msg_time.tv_sec + t.msg_time.tv_usec * 1.0e-6;
+      for (int i = 0; i < 3; i++) report.Vector[i] = t.vel[i];
+      for (int i = 0; i < 4; i++) report.Rotation[i] = vtkQuat[i];
+      report.RotationDelta = t.vel_quat_dt;
+      tracker->AddBatchReport(report);
+      }
     }
 }
 
@@ -331,22 +1663,26 @@ void VRPN_CALLBACK HandleAcceleration(void* userData, const vrpn_TRACKERACCCB t)
 
   if (t.sensor < tracker->GetNumberOfSensors()) 
     {
-    // Set the acceleration for this sensor
-    tracker->SetAcceleration((double*)t.acc, t.sensor);
-    
-    // Convert from vrpn quaternion (x, y, z, w) to vtk quaternion (w, x, y, z)
-    double vtkQuat[4];
-    vtkQuat[0] = t.acc_quat[1];
-    vtkQuat[1] = t.acc_quat[2];
-    vtkQuat[2] = t.acc_quat[3];
-    vtkQuat[3] = t.acc_quat[0];
-    tracker->SetAccelerationRotation(vtkQuat, t.sensor);
-
-    // Set the acceleration rotation for this sensor
-    tracker->SetAccelerationRotation(vtkQuat, t.sensor);
-
-    // Set the acceleration rotation delta for this sensor
-    tracker->SetAccelerationRotationDelta(t.acc_quat_dt, t.sensor);
+    // Store the raw acceleration, acceleration rotation, and acceleration 
+    // rotation delta for this sensor
+    tracker->SetTrackerAcceleration(t.acc, t.acc_quat, t.acc_quat_dt, t.sensor);
+
+    tracker->SetReportTime(t.msg_time.tv_sec + t.msg_time.tv_usec * 1.0e-6, t.sensor);
+
+    if (tracker->GetBatchMode())
+      {
+      double vtkQuat[4];
+      TrackerInformation::ConvertQuaternion(t.acc_quat, vtkQuat);
+
+      VRPNTrackerReport report;
+      report.Type = VRPNTrackerReport::Acceleration;
+      report.Sensor = t.sensor;
+      report.Time = t.msg_time.tv_sec + t.msg_time.tv_usec * 1.0e-6;
+      for (int i = 0; i < 3; i++) report.Vector[i] = t.acc[i];
+      for (int i = 0; i < 4; i++) report.Rotation[i] = vtkQuat[i];
+      report.RotationDelta = t.acc_quat_dt;
+      tracker->AddBatchReport(report);
+      }
     }
 }
 
@@ -357,31 +1693,58 @@ void vtkVRPNTracker::PrintSelf(ostream& os, vtkIndent indent)
 
   os << indent << "Tracker: "; Tracker->print_latest_report();
 
+  os << indent << "Tracker2WorldTranslation: (" << this->Tracker2WorldTranslation[0]
+     << ", " << this->Tracker2WorldTranslation[1]
+     << ", " << this->Tracker2WorldTranslation[2] << ")\n";
+  os << indent << "Tracker2WorldRotation: (" << this->Tracker2WorldRotation[0]
+     << ", " << this->Tracker2WorldRotation[1]
+     << ", " << this->Tracker2WorldRotation[2]
+     << ", " << this->Tracker2WorldRotation[3] << ")\n";
+  os << indent << "Tracker2WorldScale: " << this->Tracker2WorldScale << "\n";
+  os << indent << "PoseHistoryLength: " << this->PoseHistoryLength << "\n";
+  os << indent << "PredictionMode: " << this->PredictionMode << "\n";
+  os << indent << "PredictionTime: " << this->PredictionTime << "\n";
+  os << indent << "PositionFilter: " << this->PositionFilter << "\n";
+  os << indent << "SubscribedReports: " << this->SubscribedReports << "\n";
+  os << indent << "SubscribedSensors: ";
+  for (unsigned int i = 0; i < this->Internals->SubscribedSensors.size(); i++) 
+    {
+    os << this->Internals->SubscribedSensors[i] << " ";
+    }
+  os << "\n";
+
   os << indent << "Sensors:" << endl;
-  for (unsigned int i = 0; i < this->Internals->Sensors.size(); i++)
-    {
-    os << indent << indent << "Position: (" << this->Internals->Sensors[i].Position[0]
-                 << ", " << this->Internals->Sensors[i].Position[1]
-                 << ", " << this->Internals->Sensors[i].Position[2] << ")\n";
-    os << indent << indent << "Rotation: (" << this->Internals->Sensors[i].Rotation[0]
-                 << ", " << this->Internals->Sensors[i].Rotation[1]
-                 << ", " << this->Internals->Sensors[i].Rotation[2]
-                 << ", " << this->Internals->Sensors[i].Rotation[3] << ")\n";
-    os << indent << indent << "Velocity: (" << this->Internals->Sensors[i].Velocity[0]
-                 << ", " << this->Internals->Sensors[i].Velocity[1]
-                 << ", " << this->Internals->Sensors[i].Velocity[2] << ")\n";    
-    os << indent << indent << "Velocity Rotation: (" << this->Internals->Sensors[i].VelocityRotation[0]
-                 << ", " << this->Internals->Sensors[i].VelocityRotation[1]
-                 << ", " << this->Internals->Sensors[i].VelocityRotation[2] 
-                 << ", " << this->Internals->Sensors[i].VelocityRotation[3] << ")\n";   
-    os << indent << indent << "VelocityRotationDelta: " << this->Internals->Sensors[i].VelocityRotationDelta << "\n";    
-    os << indent << indent << "Acceleration: (" << this->Internals->Sensors[i].Acceleration[0]
-                 << ", " << this->Internals->Sensors[i].Acceleration[1]
-                 << ", " << this->Internals->Sensors[i].Acceleration[2] << ")\n";    
-    os << indent << indent << "Acceleration Rotation: (" << this->Internals->Sensors[i].AccelerationRotation[0]
-                 << ", " << this->Internals->Sensors[i].AccelerationRotation[1]
-                 << ", " << this->Internals->Sensors[i].AccelerationRotation[2]
-                 << ", " << this->Internals->Sensors[i].AccelerationRotation[3] << ")\n";   
-    os << indent << indent << "AccelerationRotationDelta: " << this->Internals->Sensors[i].AccelerationRotationDelta << "\n";   
+  for (int i = 0; i < this->GetNumberOfSensors(); i++)
+    {
+    double* position = this->GetPosition(i);
+    double* rotation = this->GetRotation(i);
+    double* velocity = this->GetVelocity(i);
+    double* velocityRotation = this->GetVelocityRotation(i);
+    double* acceleration = this->GetAcceleration(i);
+    double* accelerationRotation = this->GetAccelerationRotation(i);
+
+    os << indent << indent << "Position: (" << position[0]
+                 << ", " << position[1]
+                 << ", " << position[2] << ")\n";
+    os << indent << indent << "Rotation: (" << rotation[0]
+                 << ", " << rotation[1]
+                 << ", " << rotation[2]
+                 << ", " << rotation[3] << ")\n";
+    os << indent << indent << "Velocity: (" << velocity[0]
+                 << ", " << velocity[1]
+                 << ", " << velocity[2] << ")\n";    
+    os << indent << indent << "Velocity Rotation: (" << velocityRotation[0]
+                 << ", " << velocityRotation[1]
+                 << ", " << velocityRotation[2] 
+                 << ", " << velocityRotation[3] << ")\n";   
+    os << indent << indent << "VelocityRotationDelta: " << this->GetVelocityRotationDelta(i) << "\n";    
+    os << indent << indent << "Acceleration: (" << acceleration[0]
+                 << ", " << acceleration[1]
+                 << ", " << acceleration[2] << ")\n";    
+    os << indent << indent << "Acceleration Rotation: (" << accelerationRotation[0]
+                 << ", " << accelerationRotation[1]
+                 << ", " << accelerationRotation[2]
+                 << ", " << accelerationRotation[3] << ")\n";   
+    os << indent << indent << "AccelerationRotationDelta: " << this->GetAccelerationRotationDelta(i) << "\n";   
     }
-}
+}
\ No newline at end of file
@@ -29,11 +29,42 @@
 
 #include "vtkVRPNDevice.h"
 
+#include "vtkDeviceOneEuroFilter.h"
+
 #include <vrpn_Tracker.h>
 
+class vtkDoubleArray;
+class vtkMatrix4x4;
+class vtkPoints;
+
 // Holds vtkstd member variables, which must be hidden
 class vtkVRPNTrackerInternals;
 
+//BTX
+// A single tracker report, kept in batch mode.  Vector and Rotation hold 
+// the position, velocity, or acceleration and its rotation, depending on 
+// Type, in the same form as the corresponding get methods.  Time is the 
+// VRPN message time in seconds.
+struct VRPNTrackerReport
+{
+  enum ReportType { Position, Velocity, Acceleration };
+
+  int Type;
+  int Sensor;
+  double Time;
+  double Vector[3];
+  double Rotation[4];
+  double RotationDelta;
+};
+
+// Passed as callData with vtkVRPNDevice::TrackerBatchEvent
+struct VRPNTrackerBatch
+{
+  int NumberOfReports;
+  const VRPNTrackerReport* Reports;
+};
+//ETX
+
 class VTK_INTERACTIONDEVICE_EXPORT vtkVRPNTracker : public vtkVRPNDevice
 {
 public:
@@ -50,20 +81,98 @@ public:
   virtual void Update();
 
   // Description:
-  // Invoke vrpnDevice::TrackerEvent for observers to listen for
+  // Invoke vrpnDevice::TrackerEvent for observers to listen for, if the 
+  // pose of any sensor has been reported since the last event.  Velocity 
+  // and acceleration reports alone don't invoke it, since they don't move
+  // the sensor; read them with the pose or from the batch event.
   virtual void InvokeInteractionEvent();
 
   // Description:
-  // The number of sensors to use
+  // Hand the tracker information to the render thread when updated from 
+  // the vtkDeviceInteractor polling thread
+  virtual void SetThreaded(int threaded);
+  virtual void PublishState();
+  virtual int ConsumeState();
+
+  // Description:
+  // Allocate the report buffer when batch mode is turned on
+  virtual void SetBatchMode(int batchMode);
+
+  //BTX
+  // Description:
+  // Keep a report for the next vtkVRPNDevice::TrackerBatchEvent.  Called by 
+  // the VRPN callbacks in batch mode.
+  void AddBatchReport(const VRPNTrackerReport& report);
+  //ETX
+
+  //BTX
+  enum SubscribedReportFlags
+  {
+    PoseReports = 1,
+    VelocityReports = 2,
+    AccelerationReports = 4,
+    AllReports = 7
+  };
+  //ETX
+
+  // Description:
+  // Which reports to receive, as a combination of SubscribedReportFlags,
+  // e.g. PoseReports | VelocityReports.  Callbacks are only registered 
+  // with VRPN for these, so other reports cost no callback.  Default is 
+  // AllReports.  Must be set before Initialize().
+  vtkSetClampMacro(SubscribedReports,int,0,AllReports);
+  vtkGetMacro(SubscribedReports,int);
+
+  // Description:
+  // Only receive reports for the subscribed sensors, instead of for all 
+  // sensors, which saves a callback per report for other sensors on 
+  // servers with many sensors.  Sensors keep their VRPN numbers, and the
+  // number of sensors is increased to include them at Initialize().  
+  // Must be set before Initialize().
+  void SubscribeSensor(int sensor);
+  void RemoveAllSensorSubscriptions();
+  int GetNumberOfSubscribedSensors();
+  int GetSubscribedSensor(int i);
+
+  // Description:
+  // The number of sensors to use.  Only change it while the 
+  // vtkDeviceInteractor polling thread is stopped, since the polling 
+  // thread writes to the sensors.
   void SetNumberOfSensors(int num);
   int GetNumberOfSensors();
 
   // Description:
-  // Transformation from tracker space to world space
-  vtkSetVector3Macro(Tracker2WorldTranslation,double);
+  // Transformation from tracker space to world space, applied to positions
+  // as scale, then rotation, then translation, and to rotations as the 
+  // rotation.  Composed into a single calibration matrix when set.
+  void SetTracker2WorldTranslation(double x, double y, double z);
+  void SetTracker2WorldTranslation(double translation[3]);
   vtkGetVector3Macro(Tracker2WorldTranslation,double);
-  vtkSetVector4Macro(Tracker2WorldRotation,double);
+  void SetTracker2WorldRotation(double w, double x, double y, double z);
+  void SetTracker2WorldRotation(double rotation[4]);
   vtkGetVector4Macro(Tracker2WorldRotation,double);
+  void SetTracker2WorldScale(double scale);
+  vtkGetMacro(Tracker2WorldScale,double);
+
+  // Description:
+  // Set/Get the whole transformation from tracker space to world space as
+  // a matrix, e.g. from a calibration procedure.  Positions are 
+  // transformed by the matrix as given, and rotations by the closest pure
+  // rotation.  Setting the matrix updates the translation, rotation, and 
+  // scale to match.  Matrices that mirror or collapse space, i.e. with a 
+  // determinant that is not positive, are rejected.  Setting the 
+  // translation, rotation, or scale afterwards rebuilds the matrix from 
+  // them, which drops any non-uniform scale or shear in the matrix.
+  void SetTracker2WorldMatrix(vtkMatrix4x4* matrix);
+  void GetTracker2WorldMatrix(vtkMatrix4x4* matrix);
+
+  // Description:
+  // Transform poses from tracker space to world space with the 
+  // calibration.  Positions have 3 and rotations 4 (w, x, y, z) components
+  // per pose, as in GetPositionArray() and GetRotationArray().  The output 
+  // arrays may be the same as the input arrays.
+  void TransformPoses(int numPoses, const double* positions, const double* rotations,
+                      double* worldPositions, double* worldRotations);
 
   // Description:
   // Set/Get the tracker information
@@ -86,6 +195,106 @@ public:
   void SetAccelerationRotationDelta(double delta, int sensor = 0);
   double GetAccelerationRotationDelta(int sensor = 0);
 
+  // Description:
+  // Get the tracker information for all sensors at once.  The arrays hold 
+  // GetNumberOfSensors() tuples, in sensor order, with the same components
+  // as the corresponding per-sensor get methods.  The raw arrays are valid
+  // until the number of sensors changes or the next interaction event.
+  const double* GetPositionArray();
+  const double* GetRotationArray();
+  const double* GetVelocityArray();
+  const double* GetAccelerationArray();
+
+  // Description:
+  // Copy the tracker information for all sensors into the given points or
+  // array, resizing it to match the number of sensors
+  void GetPositions(vtkPoints* points);
+  void GetPositions(vtkDoubleArray* positions);
+  void GetRotations(vtkDoubleArray* rotations);
+  void GetVelocities(vtkDoubleArray* velocities);
+  void GetAccelerations(vtkDoubleArray* accelerations);
+
+  // Description:
+  // Number of poses kept per sensor for GetPoseAt().  The history is 
+  // allocated when set, which discards it.  0, the default, keeps none.
+  // Only change it while the vtkDeviceInteractor polling thread is 
+  // stopped.
+  void SetPoseHistoryLength(int length);
+  vtkGetMacro(PoseHistoryLength,int);
+
+  // Description:
+  // Get the world space pose of the sensor at the given time, in seconds 
+  // on the vtkTimerLog::GetUniversalTime() clock, e.g. the time the next 
+  // frame will be shown.  The position is linearly and the rotation 
+  // spherically interpolated between the poses around the time.  Times 
+  // outside the history get the oldest or newest pose.  Report times are 
+  // moved to the local clock by the smallest delay seen between sending 
+  // and arrival.  Returns 0 if there is no history for the sensor.
+  int GetPoseAt(double time, double position[3], double rotation[4], int sensor = 0);
+
+  // Description:
+  // Filter applied to the positions of all sensors before each tracker 
+  // event, with three channels per sensor.  The get methods and bulk 
+  // accessors then return filtered positions.  Rotations, the pose 
+  // history, and batch reports are not filtered.  Sensors keep being 
+  // reported as changed until their filtered positions settle.  The 
+  // filter's number of channels is set to match the sensors.
+  void SetPositionFilter(vtkDeviceOneEuroFilter* filter);
+  vtkGetObjectMacro(PositionFilter,vtkDeviceOneEuroFilter);
+
+  //BTX
+  enum PredictionModes
+  {
+    PredictFromDerivatives = 0,
+    PredictFromHistory
+  };
+  //ETX
+
+  // Description:
+  // How to predict poses.  PredictFromDerivatives extrapolates with the 
+  // velocity, acceleration, and velocity rotation reported by the tracker,
+  // and falls back to the pose history for sensors that report no 
+  // velocity.  PredictFromHistory extrapolates the change between the two
+  // newest poses in the history, which must be turned on with 
+  // SetPoseHistoryLength().  Without either, the pose is not extrapolated.
+  vtkSetClampMacro(PredictionMode,int,PredictFromDerivatives,PredictFromHistory);
+  vtkGetMacro(PredictionMode,int);
+
+  // Description:
+  // How far ahead of now to predict, in seconds, e.g. the expected time 
+  // until the next frame is shown.  The time since the newest pose was 
+  // sent is measured and predicted over as well.  Default is 0.
+  vtkSetMacro(PredictionTime,double);
+  vtkGetMacro(PredictionTime,double);
+
+  // Description:
+  // Get the world space pose of the sensor predicted for PredictionTime 
+  // from now.  The returned values are overwritten by the next call.
+  double* GetPredictedPosition(int sensor = 0);
+  double* GetPredictedRotation(int sensor = 0);
+
+  // Description:
+  // Get the world space pose of the sensor predicted for the given time, 
+  // in seconds on the vtkTimerLog::GetUniversalTime() clock.  Poses are
+  // not extrapolated by more than 0.1 s.  Returns 0 for an invalid sensor.
+  int GetPredictedPose(double time, double position[3], double rotation[4], int sensor = 0);
+
+  // Description:
+  // Store raw reports in tracker space, with VRPN (x, y, z, w) quaternions.
+  // They are converted to world space when first read by the get methods 
+  // above.  Called by the VRPN callbacks, after SetReportTime(), which 
+  // gives the time of the pose in the history.
+  void SetTrackerPose(const double* position, const double* quaternion, int sensor = 0);
+  void SetTrackerVelocity(const double* velocity, const double* quaternion, 
+                          double delta, int sensor = 0);
+  void SetTrackerAcceleration(const double* acceleration, const double* quaternion, 
+                              double delta, int sensor = 0);
+
+  // Description:
+  // Record when the last report for the sensor was sent, in seconds, and 
+  // that it arrived now.  Called by the VRPN callbacks.
+  void SetReportTime(double time, int sensor = 0);
+
 protected:
   vtkVRPNTracker();
   ~vtkVRPNTracker();
@@ -94,6 +303,25 @@ protected:
 
   double Tracker2WorldTranslation[3];
   double Tracker2WorldRotation[4];
+  double Tracker2WorldScale;
+
+  // Composed calibration, row major.  Tracker2WorldQuaternion is the 
+  // normalized rotation applied to sensor rotations.
+  double Tracker2WorldMatrix[16];
+  double Tracker2WorldQuaternion[4];
+
+  void UpdateTracker2WorldMatrix();
+
+  int PoseHistoryLength;
+
+  vtkDeviceOneEuroFilter* PositionFilter;
+
+  int SubscribedReports;
+
+  int PredictionMode;
+  double PredictionTime;
+  double PredictedPosition[3];
+  double PredictedRotation[4];
 
   vtkVRPNTrackerInternals* Internals;
 
@@ -20,6 +20,7 @@
 #include "vtkMath.h"
 #include "vtkObjectFactory.h"
 #include "vtkRenderWindow.h"
+#include "vtkTimerLog.h"
 
 vtkStandardNewMacro(vtkVRPNTrackerStyleCamera);
 vtkCxxRevisionMacro(vtkVRPNTrackerStyleCamera, "$Revision: 1.0 $");
@@ -27,6 +28,9 @@ vtkCxxRevisionMacro(vtkVRPNTrackerStyleCamera, "$Revision: 1.0 $");
 //----------------------------------------------------------------------------
 vtkVRPNTrackerStyleCamera::vtkVRPNTrackerStyleCamera() 
 { 
+  this->UsePrediction = 0;
+
+  this->RenderOnSceneModified = 1;
 }
 
 //----------------------------------------------------------------------------
@@ -42,7 +46,11 @@ void vtkVRPNTrackerStyleCamera::OnEvent(vtkObject* caller, unsigned long eid, vo
   switch(eid)
     {
     case vtkVRPNDevice::TrackerEvent:
-      this->OnTracker(tracker);
+      // Only sensor 0 drives the camera
+      if (static_cast<VRPNChangedMask*>(callData)->IsChanged(0))
+        {
+        this->OnTracker(tracker);
+        }
       break;
     }
 }
@@ -59,29 +67,39 @@ void vtkVRPNTrackerStyleCamera::SetTracker(vtkVRPNTracker* tracker)
 //----------------------------------------------------------------------------
 void vtkVRPNTrackerStyleCamera::OnTracker(vtkVRPNTracker* tracker)
 {
-  vtkCamera* camera = this->Renderer->GetActiveCamera();
+  // Get the pose
+  double position[3];
+  double rotation[4];
+  if (this->UsePrediction)
+    {
+    tracker->GetPredictedPose(vtkTimerLog::GetUniversalTime() + tracker->GetPredictionTime(), 
+                              position, rotation);
+    }
+  else
+    {
+    for (int i = 0; i < 3; i++) position[i] = tracker->GetPosition()[i];
+    for (int i = 0; i < 4; i++) rotation[i] = tracker->GetRotation()[i];
+    }
 
   // Get the rotation matrix
   double matrix[3][3];
-  vtkMath::QuaternionToMatrix3x3(tracker->GetRotation(), matrix);
+  vtkMath::QuaternionToMatrix3x3(rotation, matrix);
 
   // Calculate the view direction
   double forward[3] = { 0.0, 0.0, 1.0 };
   vtkMath::Multiply3x3(matrix, forward, forward);
-  for (int i = 0; i < 3; i++) forward[i] += tracker->GetPosition()[i];
+  for (int i = 0; i < 3; i++) forward[i] += position[i];
 
   // Calculate the up vector
   double up[3] = { 0.0, 1.0, 0.0 };
   vtkMath::Multiply3x3(matrix, up, up);
 
   // Set camera parameters
-  camera->SetPosition(tracker->GetPosition());
-  camera->SetFocalPoint(forward);
-  camera->SetViewUp(up);
-  camera->Modified();
+  this->SetCameraPose(position, forward, up);
 
   // Render
-  this->Renderer->ResetCameraClippingRange();
+  this->ResetCameraClippingRange();
+  this->SceneModified = 1;
   // Render() will be called in the interactor
 }
 
@@ -89,4 +107,6 @@ void vtkVRPNTrackerStyleCamera::OnTracker(vtkVRPNTracker* tracker)
 void vtkVRPNTrackerStyleCamera::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "UsePrediction: " << this->UsePrediction << "\n";
 }
\ No newline at end of file
@@ -46,12 +46,22 @@ public:
   // Set the tracker receiving events from
   void SetTracker(vtkVRPNTracker*);
 
+  // Description:
+  // Move the camera to the pose predicted by the tracker, using its 
+  // PredictionMode and PredictionTime, instead of the last reported pose.
+  // Default is off.
+  vtkSetMacro(UsePrediction,int);
+  vtkGetMacro(UsePrediction,int);
+  vtkBooleanMacro(UsePrediction,int);
+
 protected:
   vtkVRPNTrackerStyleCamera();
   ~vtkVRPNTrackerStyleCamera();
 
   virtual void OnTracker(vtkVRPNTracker*);
 
+  int UsePrediction;
+
 private:
   vtkVRPNTrackerStyleCamera(const vtkVRPNTrackerStyleCamera&);  // Not implemented.
   void operator=(const vtkVRPNTrackerStyleCamera&);  // Not implemented.
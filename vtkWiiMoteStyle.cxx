@@ -46,6 +46,9 @@ void vtkWiiMoteStyle::SetButton(vtkVRPNButton* button)
   if (button != NULL) 
     {
     button->SetNumberOfButtons(16);
+
+    // Zooming, panning, and rotating continue while buttons are held
+    button->RepeatWhilePressedOn();
     button->AddObserver(vtkVRPNDevice::ButtonEvent, this->DeviceCallback);
     }
 } 
@@ -17,7 +17,7 @@
 #include "vtkWiiMoteStyleCamera.h"
 
 #include "vtkCamera.h"
-#include "vtkInteractorObserver.h"
+#include "vtkDeviceViewTransform.h"
 #include "vtkMath.h"
 #include "vtkObjectFactory.h"
 #include "vtkRenderWindow.h"
@@ -42,6 +42,8 @@ vtkWiiMoteStyleCamera::vtkWiiMoteStyleCamera()
 
   this->TriggerDown = false;
   this->HomeDown = false;
+
+  this->RenderOnSceneModified = 1;
 }
 
 //----------------------------------------------------------------------------
@@ -59,8 +61,17 @@ void vtkWiiMoteStyleCamera::OnEvent(vtkObject* caller, unsigned long eid, void*
   switch(eid)
     {
     case vtkVRPNDevice::AnalogEvent:
-      this->OnAnalog(analog);
+      {
+      // Only the gravity channels are used
+      VRPNChangedMask* mask = static_cast<VRPNChangedMask*>(callData);
+      if (mask->IsChanged(vtkWiiMoteStyle::GravityX) ||
+          mask->IsChanged(vtkWiiMoteStyle::GravityY) ||
+          mask->IsChanged(vtkWiiMoteStyle::GravityZ))
+        {
+        this->OnAnalog(analog);
+        }
       break;
+      }
 
     case vtkVRPNDevice::ButtonEvent:
       this->OnButton(button);
@@ -83,17 +94,26 @@ void vtkWiiMoteStyleCamera::OnButton(vtkVRPNButton* button)
 {
   vtkCamera* camera = this->Renderer->GetActiveCamera();
 
-  // Reset
+  int modified = 0;
+
+  // Reset once per press
   if (button->GetButton(vtkWiiMoteStyle::ButtonHome))
     {
-    camera->SetPosition(0.0, 0.0, 1.0);
-    camera->SetFocalPoint(0.0, 0.0, 0.0);
-    camera->SetViewUp(0.0, 1.0, 0.0);
-    this->Renderer->ResetCamera();
+    if (!this->HomeDown)
+      {
+      camera->SetPosition(0.0, 0.0, 1.0);
+      camera->SetFocalPoint(0.0, 0.0, 0.0);
+      camera->SetViewUp(0.0, 1.0, 0.0);
+      this->Renderer->ResetCamera();
+
+      // Changes made before the reset no longer apply
+      this->ClearCameraChanges();
 
-    if (this->AnalogOutput) this->AnalogOutput->SetChannel(0, 1.0);
+      if (this->AnalogOutput) this->AnalogOutput->SetChannel(0, 1.0);
 
-    this->HomeDown = true;
+      this->HomeDown = true;
+      modified = 1;
+      }
     }
   else 
     {
@@ -108,12 +128,14 @@ void vtkWiiMoteStyleCamera::OnButton(vtkVRPNButton* button)
   if (button->GetButton(vtkWiiMoteStyle::ButtonMinus))
     {
     // Zoom out
-    camera->Dolly(1.0 - this->ZoomSensitivity);
+    this->DollyCamera(1.0 - this->ZoomSensitivity);
+    modified = 1;
     } 
   else if (button->GetButton(vtkWiiMoteStyle::ButtonPlus))
     {
     // Zoom in
-    camera->Dolly(1.0 + this->ZoomSensitivity);
+    this->DollyCamera(1.0 + this->ZoomSensitivity);
+    modified = 1;
     }
 
   // Pan
@@ -121,21 +143,25 @@ void vtkWiiMoteStyleCamera::OnButton(vtkVRPNButton* button)
     {
     // Pan left
     this->Pan(-1.0, 0.0);
+    modified = 1;
     }
   else if (button->GetButton(vtkWiiMoteStyle::ButtonRight))
     {
     // Pan right
     this->Pan(1.0, 0.0);
+    modified = 1;
     }
   else if (button->GetButton(vtkWiiMoteStyle::ButtonDown))
     {
     // Pan down
     this->Pan(0.0, -1.0);
+    modified = 1;
     }
   else if (button->GetButton(vtkWiiMoteStyle::ButtonUp))
     {
     // Pan up
     this->Pan(0.0, 1.0);
+    modified = 1;
     }
 
   // Rotate
@@ -149,20 +175,24 @@ void vtkWiiMoteStyleCamera::OnButton(vtkVRPNButton* button)
       this->OldZGravity = this->ZGravity;
       }
 
-    camera->Azimuth((this->XGravity - this->OldXGravity) * this->RotateSensitivity);
-    camera->Elevation(-(this->YGravity - this->OldYGravity) * this->RotateSensitivity);
-//    camera->Roll(-(this->ZGravity - this->OldZGravity) * this->RotateSensitivity);
-    camera->OrthogonalizeViewUp();
+    this->AzimuthCamera((this->XGravity - this->OldXGravity) * this->RotateSensitivity);
+    this->ElevationCamera(-(this->YGravity - this->OldYGravity) * this->RotateSensitivity);
+//    this->RollCamera(-(this->ZGravity - this->OldZGravity) * this->RotateSensitivity);
 
     this->TriggerDown = true;
+    modified = 1;
     }
   else
     {
     this->TriggerDown = false;
     }
 
-  this->Renderer->ResetCameraClippingRange();
-  // Render() will be called in the interactor
+  if (modified)
+    {
+    this->ResetCameraClippingRange();
+    this->SceneModified = 1;
+    // Render() will be called in the interactor
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -170,13 +200,13 @@ void vtkWiiMoteStyleCamera::Pan(double xDelta, double yDelta)
 {
   vtkCamera* camera = this->Renderer->GetActiveCamera();
 
-  double viewFocus[4], focalDepth, viewPoint[3];
+  double viewFocus[4], focalDepth;
   double newPickPoint[4], oldPickPoint[4], motionVector[3];
 
+  this->ViewTransform->Update();
+
   camera->GetFocalPoint(viewFocus);
-  vtkInteractorObserver::ComputeWorldToDisplay(this->Renderer, 
-                                               viewFocus[0], viewFocus[1], viewFocus[2], 
-                                               viewFocus);
+  this->ViewTransform->WorldToDisplay(viewFocus[0], viewFocus[1], viewFocus[2], viewFocus);
   focalDepth = viewFocus[2];
 
   // Normalize for window size
@@ -185,28 +215,16 @@ void vtkWiiMoteStyleCamera::Pan(double xDelta, double yDelta)
   xDelta *= width * this->PanSensitivity;
   yDelta *= height * this->PanSensitivity;
 
-  vtkInteractorObserver::ComputeDisplayToWorld(this->Renderer, 
-                                               xDelta, yDelta, focalDepth, 
-                                               newPickPoint);
+  this->ViewTransform->DisplayToWorld(xDelta, yDelta, focalDepth, newPickPoint);
 
-  vtkInteractorObserver::ComputeDisplayToWorld(this->Renderer, 
-                                               0, 0, focalDepth, 
-                                               oldPickPoint);
+  this->ViewTransform->DisplayToWorld(0, 0, focalDepth, oldPickPoint);
 
   // Camera motion is reversed
   motionVector[0] = newPickPoint[0] - oldPickPoint[0];
   motionVector[1] = newPickPoint[1] - oldPickPoint[1];
   motionVector[2] = newPickPoint[2] - oldPickPoint[2];
 
-  camera->GetFocalPoint(viewFocus);
-  camera->GetPosition(viewPoint);
-  camera->SetFocalPoint(motionVector[0] + viewFocus[0],
-                        motionVector[1] + viewFocus[1],
-                        motionVector[2] + viewFocus[2]);
-
-  camera->SetPosition(motionVector[0] + viewPoint[0],
-                      motionVector[1] + viewPoint[1],
-                      motionVector[2] + viewPoint[2]);
+  this->TranslateCamera(motionVector);
 }
 
 //----------------------------------------------------------------------------
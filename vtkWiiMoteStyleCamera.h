@@ -27,7 +27,7 @@
 
 #include "vtkInteractionDeviceConfigure.h"
 
-#include "vtkWiiMOteStyle.h"
+#include "vtkWiiMoteStyle.h"
 
 class VTK_INTERACTIONDEVICE_EXPORT vtkWiiMoteStyleCamera : public vtkWiiMoteStyle
 {
@@ -19,6 +19,8 @@
 #include "vtkCommand.h"
 #include "vtkObjectFactory.h"
 
+#include <math.h>
+
 #ifndef VTK_IMPLEMENT_MESA_CXX
 vtkCxxRevisionMacro(vtkWin32RenderWindowDeviceInteractor, "$Revision: 1.0 $");
 vtkStandardNewMacro(vtkWin32RenderWindowDeviceInteractor);
@@ -28,6 +30,8 @@ vtkStandardNewMacro(vtkWin32RenderWindowDeviceInteractor);
 vtkWin32RenderWindowDeviceInteractor::vtkWin32RenderWindowDeviceInteractor() 
 {
   this->DeviceInteractor = NULL;
+
+  this->MaximumWaitTime = 0.01;
 }
 
 //----------------------------------------------------------------------
@@ -59,16 +63,36 @@ void vtkWin32RenderWindowDeviceInteractor::Start()
     { 
     // Need to use PeekMessage() instead of looping on GetMessage() so 
     // that the InteractionDevice code gets called.
-    PeekMessage(&msg, NULL, 0, 0, PM_REMOVE);
-    TranslateMessage(&msg);
-    DispatchMessage(&msg);
+    while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+      {
+      if (msg.message == WM_QUIT) return;
 
-    // Receive updates from interaction devices
-    if (this->DeviceInteractor) 
+      TranslateMessage(&msg);
+      DispatchMessage(&msg);
+      }
+
+    // Receive updates from interaction devices, and only render if a 
+    // device changed the scene.  Window messages render through the usual
+    // vtkWin32RenderWindowInteractor handlers above.
+    if (this->DeviceInteractor && this->DeviceInteractor->Update()) 
       {
-      this->DeviceInteractor->Update();
+      this->DeviceInteractor->BeginRender();
       this->Render();
+      this->DeviceInteractor->EndRender();
       }
+
+    // Sleep until a message arrives or it is time to poll the devices again
+    double wait = this->MaximumWaitTime;
+    if (this->DeviceInteractor && 
+        this->DeviceInteractor->GetTimeUntilNextDeadline() < wait)
+      {
+      wait = this->DeviceInteractor->GetTimeUntilNextDeadline();
+      }
+
+    // Round up, so waits under 1 ms don't spin until the deadline
+    MsgWaitForMultipleObjects(0, NULL, FALSE, 
+                              static_cast<DWORD>(ceil(wait * 1000.0)), 
+                              QS_ALLINPUT);
     }
 }
 
@@ -101,6 +125,14 @@ void vtkWin32RenderWindowDeviceInteractor::PrintSelf(ostream& os, vtkIndent inde
 {
   this->Superclass::PrintSelf(os,indent);
 
+  os << indent << "MaximumWaitTime: " << this->MaximumWaitTime << "\n";
   os << indent << "DeviceInteractor: ";
-  this->DeviceInteractor->PrintSelf(os,indent.GetNextIndent());
+  if (this->DeviceInteractor)
+    {
+    this->DeviceInteractor->PrintSelf(os,indent.GetNextIndent());
+    }
+  else
+    {
+    os << "(none)\n";
+    }
 }
\ No newline at end of file
@@ -51,12 +51,20 @@ public:
   // Sets the device interactor to use
   void SetDeviceInteractor(vtkDeviceInteractor* interactor);
 
+  // Description:
+  // Maximum time in seconds to sleep waiting for window messages between
+  // device updates.  0 polls the devices continuously.
+  vtkSetClampMacro(MaximumWaitTime,double,0.0,VTK_DOUBLE_MAX);
+  vtkGetMacro(MaximumWaitTime,double);
+
 protected:
   vtkWin32RenderWindowDeviceInteractor();
   ~vtkWin32RenderWindowDeviceInteractor();
 
   vtkDeviceInteractor* DeviceInteractor;
 
+  double MaximumWaitTime;
+
 private:
   vtkWin32RenderWindowDeviceInteractor(const vtkWin32RenderWindowDeviceInteractor&);  // Not implemented.
   void operator=(const vtkWin32RenderWindowDeviceInteractor&);  // Not implemented.
@@ -0,0 +1,183 @@
+/*=========================================================================
+
+  Name:        vtkXRenderWindowDeviceInteractor.cxx
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0.
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+=========================================================================*/
+
+#include "vtkXRenderWindowDeviceInteractor.h"
+
+#include "vtkCommand.h"
+#include "vtkObjectFactory.h"
+
+#include <errno.h>
+#include <math.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+vtkCxxRevisionMacro(vtkXRenderWindowDeviceInteractor, "$Revision: 1.0 $");
+vtkStandardNewMacro(vtkXRenderWindowDeviceInteractor);
+
+//----------------------------------------------------------------------------
+vtkXRenderWindowDeviceInteractor::vtkXRenderWindowDeviceInteractor()
+{
+  this->DeviceInteractor = NULL;
+
+  this->MaximumWaitTime = 0.01;
+}
+
+//----------------------------------------------------------------------
+vtkXRenderWindowDeviceInteractor::~vtkXRenderWindowDeviceInteractor()
+{
+  this->SetDeviceInteractor(NULL);
+}
+
+//----------------------------------------------------------------------
+void vtkXRenderWindowDeviceInteractor::Start()
+{
+  // Let the compositing handle the event loop if it wants to.
+  if (this->HasObserver(vtkCommand::StartEvent) && !this->HandleEventLoop)
+    {
+    this->InvokeEvent(vtkCommand::StartEvent,NULL);
+    return;
+    }
+
+  if (!this->Initialized)
+    {
+    this->Initialize();
+    }
+  if (!this->Initialized)
+    {
+    return;
+    }
+
+  // Wait on the X connection and on all devices that have a file descriptor
+  int epollDescriptor = epoll_create(1);
+  if (epollDescriptor < 0)
+    {
+    vtkErrorMacro(<<"Could not create epoll descriptor!");
+    return;
+    }
+
+  struct epoll_event event;
+  event.events = EPOLLIN;
+  event.data.fd = ConnectionNumber(this->DisplayId);
+  epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, event.data.fd, &event);
+
+  // Devices are only waited on if they are sampled as soon as they have
+  // data, otherwise level-triggered readiness would spin until they are due
+  if (this->DeviceInteractor && 
+      this->DeviceInteractor->GetSamplingRate() == 0.0 &&
+      !this->DeviceInteractor->GetPollingThreadRunning())
+    {
+    for (int i = 0; i < this->DeviceInteractor->GetNumberOfInteractionDevices(); i++)
+      {
+      if (this->DeviceInteractor->GetInteractionDevicePollInterval(i) > 0.0) continue;
+
+      event.data.fd = this->DeviceInteractor->GetInteractionDevice(i)->GetFileDescriptor();
+      if (event.data.fd >= 0)
+        {
+        epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, event.data.fd, &event);
+        }
+      }
+    }
+
+  const int maxEvents = 16;
+  struct epoll_event events[maxEvents];
+
+  this->BreakLoopFlag = 0;
+  while (!this->BreakLoopFlag)
+    {
+    // Handle everything Xt has pending without blocking
+    while (XtAppPending(vtkXRenderWindowInteractor::App))
+      {
+      XtAppProcessEvent(vtkXRenderWindowInteractor::App, XtIMAll);
+      }
+
+    if (this->BreakLoopFlag) break;
+
+    // Receive updates from interaction devices, and only render if a 
+    // device changed the scene.  Expose and other X events render through
+    // the usual vtkXRenderWindowInteractor callbacks above.
+    if (this->DeviceInteractor && this->DeviceInteractor->Update())
+      {
+      this->DeviceInteractor->BeginRender();
+      this->Render();
+      this->DeviceInteractor->EndRender();
+      }
+
+    // Make sure requests are sent before sleeping, and don't sleep if 
+    // rendering has already read new events into the Xlib queue
+    XFlush(this->DisplayId);
+    if (XtAppPending(vtkXRenderWindowInteractor::App)) continue;
+
+    // Sleep until the X connection or a device has data.  Level-triggered,
+    // so the events themselves are handled above on the next iteration.
+    double wait = this->MaximumWaitTime;
+    if (this->DeviceInteractor && 
+        this->DeviceInteractor->GetTimeUntilNextDeadline() < wait)
+      {
+      wait = this->DeviceInteractor->GetTimeUntilNextDeadline();
+      }
+
+    // Round up, so waits under 1 ms don't spin until the deadline
+    int timeout = static_cast<int>(ceil(wait * 1000.0));
+    if (epoll_wait(epollDescriptor, events, maxEvents, timeout) < 0 && errno != EINTR)
+      {
+      vtkErrorMacro(<<"epoll_wait failed!");
+      break;
+      }
+    }
+
+  close(epollDescriptor);
+}
+
+//----------------------------------------------------------------------------
+void vtkXRenderWindowDeviceInteractor::SetDeviceInteractor(vtkDeviceInteractor* interactor)
+{
+  if (this->DeviceInteractor == interactor)
+    {
+    return;
+    }
+
+  if (this->DeviceInteractor != NULL)
+    {
+    this->DeviceInteractor->UnRegister(this);
+    }
+
+  this->DeviceInteractor = interactor;
+
+  if (this->DeviceInteractor != NULL)
+    {
+    this->DeviceInteractor->Register(this);
+    }
+
+  this->Modified();
+}
+
+
+//----------------------------------------------------------------------------
+void vtkXRenderWindowDeviceInteractor::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "MaximumWaitTime: " << this->MaximumWaitTime << "\n";
+  os << indent << "DeviceInteractor: ";
+  if (this->DeviceInteractor)
+    {
+    this->DeviceInteractor->PrintSelf(os,indent.GetNextIndent());
+    }
+  else
+    {
+    os << "(none)\n";
+    }
+}
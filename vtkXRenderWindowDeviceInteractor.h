@@ -0,0 +1,81 @@
+/*=========================================================================
+
+  Name:        vtkXRenderWindowDeviceInteractor.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0.
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+=========================================================================*/
+// .NAME vtkXRenderWindowDeviceInteractor
+// .SECTION Description
+// vtkXRenderWindowDeviceInteractor adds interaction with external devices to
+// vtkXRenderWindowInteractor.  Examples of such devices include
+// multi-touch interfaces and various devices supported by the Virtual
+// Reality Peripheral Network (VRPN:
+// http://www.cs.unc.edu/Research/vrpn/).
+//
+// Instead of busy-polling, the event loop sleeps in a single epoll wait on
+// the X connection and on every device that provides a file descriptor,
+// and wakes as soon as either has data.  Devices without a file descriptor
+// are serviced at least every MaximumWaitTime seconds.  If the 
+// vtkDeviceInteractor has a SamplingRate or a polling thread, the loop 
+// wakes at its sample and render deadlines instead of waiting on devices.
+// Requires Linux.
+
+// .SECTION see also
+// vtkInteractionDeviceManager vtkInteractionDevice
+// vtkDeviceInteractorStyle
+
+#ifndef __vtkXRenderWindowDeviceInteractor_h
+#define __vtkXRenderWindowDeviceInteractor_h
+
+#include "vtkInteractionDeviceConfigure.h"
+
+#include "vtkXRenderWindowInteractor.h"
+
+#include "vtkDeviceInteractor.h"
+
+class VTK_INTERACTIONDEVICE_EXPORT vtkXRenderWindowDeviceInteractor : public vtkXRenderWindowInteractor
+{
+public:
+  static vtkXRenderWindowDeviceInteractor* New();
+  vtkTypeRevisionMacro(vtkXRenderWindowDeviceInteractor,vtkXRenderWindowInteractor);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // This will start up the event loop and never return. If you
+  // call this method it will loop processing events until the
+  // application is exited.
+  virtual void Start();
+
+  // Description:
+  // Sets the device interactor to use
+  void SetDeviceInteractor(vtkDeviceInteractor* interactor);
+
+  // Description:
+  // Maximum time in seconds to sleep waiting for events.  Bounds the
+  // latency of devices that cannot be waited on and of Xt timers.
+  vtkSetClampMacro(MaximumWaitTime,double,0.0,VTK_DOUBLE_MAX);
+  vtkGetMacro(MaximumWaitTime,double);
+
+protected:
+  vtkXRenderWindowDeviceInteractor();
+  ~vtkXRenderWindowDeviceInteractor();
+
+  vtkDeviceInteractor* DeviceInteractor;
+
+  double MaximumWaitTime;
+
+private:
+  vtkXRenderWindowDeviceInteractor(const vtkXRenderWindowDeviceInteractor&);  // Not implemented.
+  void operator=(const vtkXRenderWindowDeviceInteractor&);  // Not implemented.
+};
+
+#endif